@@ -184,26 +184,20 @@ float SpaceShip::getAngle() const
 	return angle;
 }
 
-bool SpaceShip::pullofGravity(Planet forcer, SpaceShip &ship, int timeStep, bool gravity_enabled)
+bool SpaceShip::isInside(const Planet& planet) const
 {
-	DistanceCalculationResult distRes = PhysicsUtils::calculateDistance(ship, forcer);
+	return PhysicsUtils::calculateDistance(*this, planet).dist < planet.getRadius();
+}
 
-    // Simple gravity + destruction check
-	if (distRes.dist < forcer.getRadius())
-	{
-		destroy();
-		return false;
-	}
-	else if (gravity_enabled)
-	{
-		Acceleration2D acc_sum;
-		PhysicsUtils::accumulate_acceleration(distRes, acc_sum, forcer);
+void SpaceShip::pullofGravity(const Planet& forcer, int timeStep)
+{
+	DistanceCalculationResult distRes = PhysicsUtils::calculateDistance(*this, forcer);
 
-		speed.x += acc_sum.x * timeStep / mass;
-		speed.y += acc_sum.y * timeStep / mass;
-	}
+	Acceleration2D acc_sum;
+	PhysicsUtils::accumulate_acceleration(distRes, acc_sum, forcer);
 
-	return true;
+	speed.x += acc_sum.x * timeStep / mass;
+	speed.y += acc_sum.y * timeStep / mass;
 }
 
 void SpaceShip::reset(sf::Vector2f p)
@@ -343,32 +337,36 @@ void SpaceShip::updateGrapple(double dt, Space& space)
     sf::Vector2f end = start + movement;
     grapple.pos = end;
 
-    // Check for collisions with planets
-    for (const auto& planet : space.planets)
+    // Check for collisions with planets, the first one in the list catches the hook
+    int hit_index = -1;
+    space.planet_index.querySegment(start.x, start.y, end.x, end.y, 0.0, [&](const SpatialIndex::Entry& e)
     {
-        sf::Vector2f planetPos(planet.getx(), planet.gety());
+        if (hit_index >= 0 && e.item > hit_index) return;
+        const Planet& planet = space.planets[e.item];
         sf::Vector2f intersection;
+        if (PhysicsUtils::segmentIntersectsCircle(start, end, sf::Vector2f(planet.getx(), planet.gety()), planet.getRadius(), intersection))
+            hit_index = e.item;
+    });
 
-        if (PhysicsUtils::segmentIntersectsCircle(start, end, planetPos, planet.getRadius(), intersection))
+    if (hit_index >= 0)
+    {
+        const Planet& planet = space.planets[hit_index];
+        grapple.flying = false;
+
+        // Check if supported (Not stars or compact remnants)
+        bool supported = !planet.isAnyStarType() && !planet.isCompactRemnant();
+
+        if (supported)
         {
-            // HIT!
-            grapple.flying = false;
-            
-            // Check if supported (Not stars or compact remnants)
-            bool supported = !planet.isAnyStarType() && !planet.isCompactRemnant();
+            tug_active = true;
+            tug_target_id = planet.getId();
 
-            if (supported)
-            {
-                tug_active = true;
-                tug_target_id = planet.getId();
-                
-                double dx = planet.getx() - pos.x;
-                double dy = planet.gety() - pos.y;
-                tug_rest_length = std::hypot(dx, dy);
-                tug_activity_score = 0.5f; // Initial tension
-            }
-            return;
+            double dx = planet.getx() - pos.x;
+            double dy = planet.gety() - pos.y;
+            tug_rest_length = std::hypot(dx, dy);
+            tug_activity_score = 0.5f; // Initial tension
         }
+        return;
     }
 
     // Range limit for grapple
@@ -480,6 +478,7 @@ void SpaceShip::renderProjectiles(sf::RenderTarget& window)
 
 void SpaceShip::checkProjectileCollisions(Space& space, double dt)
 {
+    std::pmr::vector<int> candidates(space.frameArena().resource());
     for (auto it = projectiles.begin(); it != projectiles.end(); )
     {
         bool hit = false;
@@ -488,22 +487,20 @@ void SpaceShip::checkProjectileCollisions(Space& space, double dt)
         sf::Vector2f movement = it->vel * (float)dt;
         sf::Vector2f end = start + movement;
 
-        // Iterating over planets to check collision
-        for (const auto& planet : space.planets)
+        // Planets along the path, in list order since a weak hit lets the projectile go on
+        candidates.clear();
+        space.planet_index.querySegment(start.x, start.y, end.x, end.y, it->getRad(it->power, it->age),
+            [&](const SpatialIndex::Entry& e) { candidates.push_back(e.item); });
+        std::sort(candidates.begin(), candidates.end());
+
+        for (const int index : candidates)
         {
+            const Planet& planet = space.planets[index];
             if (planet.isMarkedForRemoval() || planet.disintegrationGraceTimeIsActive(space.curr_time)) continue;
 
             sf::Vector2f planetPos(planet.getx(), planet.gety());
             sf::Vector2f intersection;
-            
-            // Check broadphase (dist < radius + movement len)
-            float dx = planet.getx() - start.x;
-            float dy = planet.gety() - start.y;
-            float distSq = dx*dx + dy*dy;
             float p_radius = it->getRad(it->power, it->age);
-            float maxReach = planet.getRadius() + p_radius + std::hypot(movement.x, movement.y);
-            
-            if (distSq > maxReach * maxReach) continue;
 
             if (PhysicsUtils::segmentIntersectsCircle(start, end, planetPos, planet.getRadius() + p_radius, intersection))
             {
@@ -528,7 +525,7 @@ void SpaceShip::checkProjectileCollisions(Space& space, double dt)
                 if (planet.getMass() < PROJECTILE_DAMAGE_MASS_LIMIT * pow((it->power),2.0))
                 {
                     // Explode object
-                    space.explodePlanet(planet);
+                    space.explodePlanet(planet.getId());
                     // Visual pop
                     space.addExplosion(intersection, planet.getRadius() * 3 * it->power, planet.getVelocity(), 25);
                     
@@ -559,21 +556,17 @@ void SpaceShip::toggleTug(Space& space)
         return;
     }
 
-    // Find target
+    // Find target, the closest planet in range
     int best_id = -1;
     double best_dist = TUG_RANGE;
 
-    for (const auto& planet : space.planets)
+    std::vector<SpatialIndex::Entry> closest;
+    space.planet_index.nearest(pos.x, pos.y, 1, TUG_RANGE, closest);
+    if (!closest.empty())
     {
-        double dx = planet.getx() - pos.x;
-        double dy = planet.gety() - pos.y;
-        double dist = std::hypot(dx, dy);
-
-        if (dist < best_dist)
-        {
-            best_dist = dist;
-            best_id = planet.getId();
-        }
+        const Planet& planet = space.planets[closest[0].item];
+        best_dist = std::hypot(planet.getx() - pos.x, planet.gety() - pos.y);
+        best_id = planet.getId();
     }
 
     if (best_id != -1)
@@ -592,7 +585,7 @@ void SpaceShip::updateTug(Space& space, double dt)
 
     if (!tug_active) return;
     
-    Planet* target = space.findPlanetPtr(tug_target_id);
+    Planet* target = space.findPlanet(tug_target_id);
     if (!target)
     {
         tug_active = false;
@@ -653,10 +646,10 @@ void SpaceShip::updateTug(Space& space, double dt)
         }
     }
     
-    // Pull planet towards ship (or push if compressed)
-    sf::Vector2f p_vel = target->getVelocity();
-    p_vel.x -= dir_x * total_force * dt / target->getMass();
-    p_vel.y -= dir_y * total_force * dt / target->getMass();
+    // Pull planet towards ship (or push if compressed), on the velocity the space integrates
+    Space::PlanetMotion p_motion = *space.getPlanetMotion(tug_target_id);
+    p_motion.vx -= dir_x * total_force * dt / target->getMass();
+    p_motion.vy -= dir_y * total_force * dt / target->getMass();
 
     // Drift Correction:
     // The spring acts strongly on the planet to balance gravity on the ship (which is weak).
@@ -665,10 +658,10 @@ void SpaceShip::updateTug(Space& space, double dt)
     double grav_force = G * target->getMass() * mass / std::max(dist*dist, 1.0);
     double extra_grav = grav_force * (1.0 / reaction_scale - 1.0);
 
-    p_vel.x -= dir_x * extra_grav * dt / target->getMass();
-    p_vel.y -= dir_y * extra_grav * dt / target->getMass();
+    p_motion.vx -= dir_x * extra_grav * dt / target->getMass();
+    p_motion.vy -= dir_y * extra_grav * dt / target->getMass();
 
-    target->setVelocity(p_vel);
+    space.setPlanetMotion(tug_target_id, p_motion);
     
     // Pull ship towards planet (Reaction force, scaled down for playability)
     speed.x += dir_x * total_force * reaction_scale * dt / mass;
@@ -694,7 +687,7 @@ void SpaceShip::renderTug(sf::RenderTarget& window, Space& space)
     }
 
     if (!tug_active) return;
-     Planet* target = space.findPlanetPtr(tug_target_id);
+     Planet* target = space.findPlanet(tug_target_id);
     if (!target) return;
 
     // Visual intensity based on score
@@ -731,8 +724,14 @@ void SpaceShip::checkShield(Space& space, double dt)
 
     if (!exist) return;
 
-    for (auto& planet : space.planets)
+    // Planets touching the shield, in list order
+    std::pmr::vector<int> touching(space.frameArena().resource());
+    space.planet_index.queryCircle(pos.x, pos.y, shield_radius, [&](const SpatialIndex::Entry& e) { touching.push_back(e.item); });
+    std::sort(touching.begin(), touching.end());
+
+    for (const int index : touching)
     {
+        const Planet& planet = space.planets[index];
         if (planet.isMarkedForRemoval()) continue;
         if (planet.getMass() >= TERRESTRIALLIMIT) continue; // Too big
 
@@ -861,7 +860,7 @@ void SpaceShip::updateTrajectory(Space& space)
     ship_proxy.setVelocity(speed);
 
     // Ship's trajectory length is half of the new object's (200 / 2 = 100)
-    last_prediction = predict_trajectory(space.planets, ship_proxy, 100);
+    predict_trajectory(space.planets, ship_proxy, last_prediction, space.frameArena().resource(), 100);
 
     // Make it blue
     for (auto& v : last_prediction.path)
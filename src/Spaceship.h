@@ -80,7 +80,8 @@ public:
     void switchTool(Space& space);
     std::string getToolName() const;
 
-	bool pullofGravity(Planet forcer, SpaceShip &ship, int timeStep, bool gravity_enabled);
+	bool isInside(const Planet& planet) const;
+	void pullofGravity(const Planet& forcer, int timeStep);
 	sf::Vector2f getpos() const;
     sf::Vector2f getPosition() const { return pos; }
 	sf::Vector2f getvel() const;
@@ -0,0 +1,67 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<size_t> allocations{ 0 };
+
+}
+
+size_t AllocationCounter::count() noexcept
+{
+	return allocations.load(std::memory_order_relaxed);
+}
+
+#ifndef NDEBUG
+
+/*
+ * The array and nothrow forms of the standard library forward to these, and the sized deletes below
+ * forward to the unsized ones, so the replacements cover every new and delete expression. Over-aligned
+ * blocks keep the pointer malloc returned just below them.
+ */
+void* operator new(std::size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	const size_t align = static_cast<size_t>(alignment);
+	void* raw = std::malloc(size + align + sizeof(void*));
+	if (!raw)
+		throw std::bad_alloc();
+	const uintptr_t address = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + align - 1) & ~(uintptr_t(align) - 1);
+	reinterpret_cast<void**>(address)[-1] = raw;
+	return reinterpret_cast<void*>(address);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+	if (p)
+		std::free(static_cast<void**>(p)[-1]);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	operator delete(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept
+{
+	operator delete(p, alignment);
+}
+
+#endif
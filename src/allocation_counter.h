@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+ * Heap allocations made through the global operator new, on every thread.
+ *
+ * Debug builds replace operator new to count them, so the benchmark can check that a steady-state tick
+ * allocates nothing. Release builds keep the standard allocator and report no count.
+ */
+namespace AllocationCounter
+{
+#ifdef NDEBUG
+	constexpr bool enabled = false;
+#else
+	constexpr bool enabled = true;
+#endif
+
+	// Allocations since the start of the program, 0 when not enabled
+	[[nodiscard]] size_t count() noexcept;
+}
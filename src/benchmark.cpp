@@ -1,19 +1,429 @@
 #include "space.h"
+#include "roche_limit.h"
+#include "physics/pair_kernel.h"
+#include "physics/mixed_kernel.h"
+#include "task_pool.h"
+#include "parallel_tuning.h"
+#include "allocation_counter.h"
 #include <iostream>
+#include <iomanip>
 #include <chrono>
 #include <vector>
 #include <string>
 #include <cstdlib>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <thread>
 #include <SFML/Graphics.hpp>
 #include <TGUI/TGUI.hpp>
 #include <TGUI/Backend/SFML-Graphics.hpp>
 
+// Relative force error of the approximate solvers against the direct pair sum, over the current planets
+static void reportSolverAccuracy(const std::vector<Planet>& planets, double bh_theta, double fmm_theta)
+{
+    std::vector<TreeBody> bodies;
+    for (size_t i = 0; i < planets.size(); ++i) {
+        const auto& p = planets[i];
+        bodies.push_back({ p.getPosition().x, p.getPosition().y, G * p.getMass(),
+            RocheLimit::REMNANT_DIST_MULTIPLIER * p.getRadius(), static_cast<int>(i) });
+    }
+    const size_t n = bodies.size();
+    if (n < 2) return;
+
+    const auto pair_accel = [&](size_t i, const TreeBody& other, double& ax, double& ay) {
+        const double dx = other.x - bodies[i].x;
+        const double dy = other.y - bodies[i].y;
+        const double dist2 = std::max(dx * dx + dy * dy, 0.01);
+        const double factor = other.g_mass / (dist2 * std::sqrt(dist2));
+        ax += factor * dx;
+        ay += factor * dy;
+    };
+
+    std::vector<double> exact_x(n, 0.0), exact_y(n, 0.0);
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = 0; j < n; ++j)
+            if (i != j) pair_accel(i, bodies[j], exact_x[i], exact_y[i]);
+
+    const auto report = [&](const std::string& name, auto&& evaluate, double build_ms) {
+        double sum_rel = 0.0, max_rel = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            FarField far;
+            double ax = 0.0, ay = 0.0;
+            evaluate(i, far, [&](const TreeBody& other) {
+                if (other.index != static_cast<int>(i)) pair_accel(i, other, ax, ay);
+                return true;
+            });
+            ax += far.ax;
+            ay += far.ay;
+            const double rel = std::hypot(ax - exact_x[i], ay - exact_y[i]) / std::max(std::hypot(exact_x[i], exact_y[i]), 1e-300);
+            sum_rel += rel;
+            max_rel = std::max(max_rel, rel);
+        }
+        std::cout << std::left << std::setw(22) << name << std::right
+                  << " mean rel error " << std::scientific << std::setprecision(2) << sum_rel / n
+                  << "  max rel error " << max_rel
+                  << std::fixed << "  build " << build_ms << " ms" << std::endl;
+    };
+
+    std::cout << "Force accuracy against the direct sum (" << n << " bodies):" << std::endl;
+
+    BarnesHutTree tree;
+    auto start = std::chrono::high_resolution_clock::now();
+    tree.build(bodies);
+    std::chrono::duration<double, std::milli> build_time = std::chrono::high_resolution_clock::now() - start;
+    report("Barnes-Hut theta " + std::to_string(bh_theta).substr(0, 4),
+        [&](size_t i, FarField& far, auto&& near) { tree.walk(bodies[i].x, bodies[i].y, bodies[i].reach, bh_theta, far, near); },
+        build_time.count());
+
+    for (int order = 0; order <= 10; order += 2) {
+        FmmSolver fmm;
+        start = std::chrono::high_resolution_clock::now();
+        fmm.build(bodies, order, fmm_theta);
+        build_time = std::chrono::high_resolution_clock::now() - start;
+        report("FMM order " + std::to_string(order) + " theta " + std::to_string(fmm_theta).substr(0, 4),
+            [&](size_t i, FarField& far, auto&& near) { fmm.query(static_cast<int>(i), far, near); },
+            build_time.count());
+    }
+    std::cout << std::defaultfloat;
+}
+
+// Error of the mixed precision pair kernel against the double one, over the current planets
+static void reportPrecisionAccuracy(const std::vector<Planet>& planets)
+{
+    BodyStore store;
+    for (size_t i = 0; i < planets.size(); ++i) {
+        const auto& p = planets[i];
+        store.push(p.getPosition().x, p.getPosition().y, 0.0, 0.0, 0.0, 0.0, p.getMass(), p.getRadius(),
+            RocheLimit::REMNANT_DIST_MULTIPLIER * p.getRadius(), p.emitsHeat() ? p.giveThermalEnergy(1) : 0.0,
+            p.getType(), p.getId(), static_cast<int>(i));
+    }
+    const int n = store.size();
+    if (n < 2) return;
+
+    std::vector<PairKernel::Sums> exact(n), mixed(n);
+    auto start = std::chrono::high_resolution_clock::now();
+    PairKernel::accumulate(store, 0, n, exact.data());
+    std::chrono::duration<double, std::milli> double_time = std::chrono::high_resolution_clock::now() - start;
+
+    MixedPairKernel kernel;
+    start = std::chrono::high_resolution_clock::now();
+    kernel.prepare(store);
+    kernel.accumulate(0, n, mixed.data());
+    std::chrono::duration<double, std::milli> mixed_time = std::chrono::high_resolution_clock::now() - start;
+
+    double sum_rel = 0.0, max_rel = 0.0, max_heat_rel = 0.0;
+    int attractor_mismatches = 0, missed_contacts = 0;
+    for (int i = 0; i < n; ++i) {
+        const double rel = std::hypot(mixed[i].ax - exact[i].ax, mixed[i].ay - exact[i].ay) / std::max(std::hypot(exact[i].ax, exact[i].ay), 1e-300);
+        sum_rel += rel;
+        max_rel = std::max(max_rel, rel);
+        if (exact[i].heat > 0.0)
+            max_heat_rel = std::max(max_heat_rel, std::abs(mixed[i].heat - exact[i].heat) / exact[i].heat);
+        if (mixed[i].max_slot != exact[i].max_slot) ++attractor_mismatches;
+        if (exact[i].contact && !mixed[i].contact) ++missed_contacts;
+    }
+
+    std::cout << "Mixed precision against double (" << n << " bodies, " << PairKernel::instructionSet() << "):" << std::endl;
+    std::cout << "  mean rel error " << std::scientific << std::setprecision(2) << sum_rel / n
+              << "  max rel error " << max_rel << "  max heat rel error " << max_heat_rel << std::endl;
+    std::cout << std::fixed << "  strongest attractor mismatches " << attractor_mismatches
+              << "  missed contacts " << missed_contacts << std::endl;
+    std::cout << "  double " << double_time.count() << " ms  mixed " << mixed_time.count() << " ms" << std::endl;
+    std::cout << std::defaultfloat;
+}
+
+// Wall time each integrator needs to cover the same span of a planetary system within the given
+// relative energy drift, taking the largest timestep that stays within it
+static void reportIntegratorDrift(double target_drift, GravitySolver solver)
+{
+    const double span = 4000.0;
+    const float timesteps[] = { 1024.f, 512.f, 256.f, 128.f, 64.f, 32.f, 16.f, 8.f, 4.f, 2.f, 1.f };
+    const std::pair<const char*, Integrator> integrators[] = {
+        { "leapfrog", Integrator::LEAPFROG },
+        { "yoshida4", Integrator::YOSHIDA4 },
+        { "hermite4", Integrator::HERMITE4 },
+        { "wisdom_holman", Integrator::WISDOM_HOLMAN }
+    };
+
+    // Gas giant with light rocky moons on circular orbits, nothing that burns fuel, collides or breaks up
+    const auto populate = [](Space& space) {
+        const double central_mass = 300.0;
+        space.addPlanet(Planet(central_mass, 0.0, 0.0, 0.0, 0.0));
+        for (int i = 0; i < 30; ++i) {
+            const double r = 80.0 + 15.0 * i;
+            const double angle = 2.39996 * i;
+            const double v = std::sqrt(G * central_mass / r);
+            space.addPlanet(Planet(0.05, r * std::cos(angle), r * std::sin(angle), -v * std::sin(angle), v * std::cos(angle)));
+        }
+        space.flushPlanets();
+    };
+
+    const auto energy = [](const std::vector<Planet>& planets) {
+        double e = 0.0;
+        for (size_t i = 0; i < planets.size(); ++i) {
+            const auto v = planets[i].getVelocity();
+            e += 0.5 * planets[i].getMass() * (v.x * v.x + v.y * v.y);
+            for (size_t j = i + 1; j < planets.size(); ++j) {
+                const auto d = planets[j].getPosition() - planets[i].getPosition();
+                e -= G * planets[i].getMass() * planets[j].getMass() / std::hypot(d.x, d.y);
+            }
+        }
+        return e;
+    };
+
+    std::cout << "Wall time to simulate " << span << " time units within relative energy drift "
+              << std::scientific << std::setprecision(1) << target_drift << std::defaultfloat << ":" << std::endl;
+
+    for (const auto& [name, integrator] : integrators) {
+        bool reached = false;
+        for (const float dt : timesteps) {
+            Space space;
+            space.config.gravity_solver = solver;
+            space.config.integrator = integrator;
+            space.config.heat_enabled = false;
+            space.setTimestep(dt);
+            populate(space);
+
+            const size_t n_bodies = space.getPlanets().size();
+            const double e0 = energy(space.getPlanets());
+            const int steps = static_cast<int>(span / dt);
+            double max_drift = 0.0;
+
+            const auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < steps && space.getPlanets().size() == n_bodies; ++i) {
+                space.update();
+                max_drift = std::max(max_drift, std::abs(energy(space.getPlanets()) - e0) / std::abs(e0));
+            }
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+            if (space.getPlanets().size() != n_bodies || max_drift > target_drift)
+                continue;
+
+            std::cout << "  " << std::left << std::setw(14) << name << std::right
+                      << " timestep " << std::setw(5) << dt
+                      << "  drift " << std::scientific << std::setprecision(2) << max_drift
+                      << std::fixed << "  force evaluations " << space.getForceEvaluations()
+                      << "  wall " << elapsed.count() << " ms" << std::defaultfloat << std::endl;
+            reached = true;
+            break;
+        }
+        if (!reached)
+            std::cout << "  " << std::left << std::setw(14) << name << std::right
+                      << " does not reach the target down to timestep " << timesteps[std::size(timesteps) - 1] << std::endl;
+    }
+}
+
+// Wall time per tick with the planets and dust in scattered memory order, against the same scene kept in
+// space-filling-curve order. `configure` applies the solver settings of the run.
+template <typename Configure>
+static void reportReorderSpeedup(int num_planets, int num_particles, int iterations, Configure&& configure)
+{
+    // Grid positions handed out in a scrambled order, so that insertion order says nothing about position
+    const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(num_planets))));
+    std::vector<int> cells(static_cast<size_t>(side) * side);
+    for (size_t i = 0; i < cells.size(); ++i) cells[i] = static_cast<int>(i);
+    std::mt19937 rng(12345);
+    std::shuffle(cells.begin(), cells.end(), rng);
+
+    const auto run = [&](int reorder_interval) {
+        Space space;
+        configure(space);
+        space.config.reorder_interval = reorder_interval;
+        for (int i = 0; i < num_planets; ++i) {
+            const double x = (cells[i] % side) * 100.0 - side * 50.0;
+            const double y = (cells[i] / side) * 100.0 - side * 50.0;
+            space.addPlanet(Planet(100.0 + (i % 10) * 10.0, x, y, (i % 3) - 1.0, ((i / 3) % 3) - 1.0));
+        }
+        space.flushPlanets();
+        std::uniform_real_distribution<double> coord(-side * 50.0, side * 50.0);
+        for (int i = 0; i < num_particles; ++i)
+            space.addParticle(sf::Vector2f(static_cast<float>(coord(rng)), static_cast<float>(coord(rng))), sf::Vector2f(0, 0), 2.0, 10000.0);
+
+        // The first tick sorts, the timing covers the steady state
+        space.update();
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; ++i)
+            space.update();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+        return std::make_pair(elapsed.count() / std::max(iterations, 1), space.getReorderSorts());
+    };
+
+    std::cout << "Space-filling-curve reordering (" << num_planets << " planets, " << num_particles << " particles, scattered insertion order):" << std::endl;
+    const auto [scattered_ms, no_sorts] = run(0);
+    const auto [sorted_ms, sorts] = run(1);
+    std::cout << std::fixed << std::setprecision(2)
+              << "  insertion order " << scattered_ms << " ms per tick" << std::endl
+              << "  curve order     " << sorted_ms << " ms per tick (" << sorts << " planet sorts)" << std::endl
+              << "  speedup         " << scattered_ms / sorted_ms << "x" << std::defaultfloat << std::endl;
+}
+
+// A star with light planets on circular orbits, in a sunflower layout evenly spread over the disc inside the
+// bound, so any count stays clear of mergers. Orbital periods span two orders of magnitude.
+static void addOrbitingDisc(Space& space, int num_planets)
+{
+    const double star_mass = 1000.0;
+    const double planet_mass = 0.5;
+    space.addPlanet(Planet(star_mass, 0.0, 0.0, 0.0, 0.0));
+    for (int i = 0; i < num_planets - 1; ++i) {
+        const double r = 300.0 + 6700.0 * std::sqrt(static_cast<double>(i) / std::max(num_planets - 1, 1));
+        const double angle = 2.39996 * i;
+        const double v = std::sqrt(G * (star_mass + planet_mass * i) / r);	// around the mass inside the orbit
+        space.addPlanet(Planet(planet_mass, r * std::cos(angle), r * std::sin(angle), -v * std::sin(angle), v * std::cos(angle)));
+    }
+    space.flushPlanets();
+}
+
+// Wall time of block timesteps on the orbiting disc, against global steps of the same tick and of the finest
+// rung, over the same simulated time. Force evaluations alone hide the cost of the substeps themselves. The tick
+// is long enough that the inner orbits take a few ticks and need finer rungs than the outer ones.
+template <typename Configure>
+static void reportBlockTimestepCost(int num_planets, int iterations, Configure&& configure)
+{
+    constexpr float TICK = 5000.0f;
+
+    const auto run = [&](bool block, int ticks_per_tick) {
+        Space space;
+        configure(space);
+        space.config.block_timesteps = block;
+        space.setTimestep(TICK / ticks_per_tick);
+        addOrbitingDisc(space, num_planets);
+
+        // The first tick settles the rungs, the timing covers the steady state
+        space.update();
+        const double energy_before = space.getAggregates().energy();
+        const size_t evaluations_before = space.getForceEvaluations();
+        const auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations * ticks_per_tick; ++i)
+            space.update();
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+        struct Result { double ms, evaluations, drift; };
+        return Result{ elapsed.count() / std::max(iterations, 1),
+            static_cast<double>(space.getForceEvaluations() - evaluations_before) / std::max(iterations, 1),
+            std::abs(space.getAggregates().energy() / energy_before - 1.0) };
+    };
+
+    const int finest = 1 << SimConfig{}.max_time_rung;
+
+    std::cout << "Block timesteps (" << num_planets << " planets on circular orbits, per tick of " << TICK << "):" << std::endl;
+    const auto print = [](const char* name, const auto& result) {
+        std::cout << "  " << name << std::fixed << std::setprecision(2) << result.ms << " ms, "
+                  << std::setprecision(0) << result.evaluations << " force evaluations, "
+                  << std::setprecision(3) << 1000.0 * result.ms / std::max(result.evaluations, 1.0) << " ms per 1000, "
+                  << std::scientific << std::setprecision(1) << result.drift << " energy drift" << std::defaultfloat << std::endl;
+    };
+    print("block timesteps        ", run(true, 1));
+    print("global, same tick      ", run(false, 1));
+    print("global, finest rung    ", run(false, finest));
+}
+
+// Heap allocations of the ticks of a quiet scene once its buffers have warmed up: the orbiting disc in a field of
+// dust, nothing that merges or breaks up. Runs on at least two threads, so the pool's queues are part of the check.
+// False if any tick allocated.
+template <typename Configure>
+static bool reportSteadyAllocations(int num_planets, int num_particles, int iterations, Configure&& configure)
+{
+    Space space;
+    configure(space);
+    const int threads = space.config.worker_threads > 0 ? space.config.worker_threads : static_cast<int>(std::thread::hardware_concurrency());
+    space.config.worker_threads = std::max(threads, 2);
+    addOrbitingDisc(space, num_planets);
+    std::mt19937 rng(12345);
+    std::uniform_real_distribution<double> coord(-2000.0, 2000.0);
+    for (int i = 0; i < num_particles; ++i)
+        space.addParticle(sf::Vector2f(static_cast<float>(coord(rng)), static_cast<float>(coord(rng))), sf::Vector2f(0, 0), 2.0, 1e9);
+
+    // The warm-up covers a reorder, whose scratch grows on the first sort
+    const int warm_up = std::max(iterations, space.config.reorder_interval + 1);
+    for (int i = 0; i < warm_up; ++i)
+        space.update();
+
+    const size_t n_planets = space.getPlanets().size();
+    size_t allocations = 0;
+    int allocating_ticks = 0;
+    for (int i = 0; i < iterations; ++i) {
+        const size_t count_before = AllocationCounter::count();
+        space.update();
+        const size_t made = AllocationCounter::count() - count_before;
+        allocations += made;
+        allocating_ticks += made > 0;
+    }
+
+    std::cout << "Heap allocations after " << warm_up << " warm-up ticks (" << n_planets << " planets, "
+              << num_particles << " particles, " << TaskPool::global().threadCount() << " threads): " << allocations << " in " << allocating_ticks << " of "
+              << iterations << " ticks" << std::endl;
+    std::cout << "Frame arena: " << space.frameArena().capacity() / 1024 << " KiB, grown "
+              << space.frameArena().growCount() << " times" << std::endl;
+    if (space.getPlanets().size() != n_planets)
+        std::cout << "Planets merged or broke up during the check, the count does not describe a steady state" << std::endl;
+    return allocating_ticks == 0;
+}
+
+// Jerk of the Hermite pass against a plain sum over the pairs the force pass keeps: an unrelated body
+// first, then two fragments of one family, which must not feel each other. False if they differ.
+static bool checkFamilyJerk()
+{
+    BodyStore store;
+    store.push(0.0, 0.0, 0.0, 0.3, 0.0, 0.0, 200.0, 5.0, 10.0, 0.0, STAR, 0, 0);
+    store.push(40.0, 5.0, -0.2, 0.1, 0.0, 0.0, 2.0, 1.0, 2.0, 0.0, ROCKY, 1, 1, 0, 0.0, 0.0, 7);
+    store.push(42.0, 6.0, 0.1, -0.4, 0.0, 0.0, 3.0, 1.0, 2.0, 0.0, ROCKY, 2, 2, 0, 0.0, 0.0, 7);
+    const int n = store.size();
+
+    std::vector<double> jx(n), jy(n);
+    PairKernel::accumulateJerk(store, 0, n, jx.data(), jy.data());
+    PairKernel::removeFamilyJerk(store, 0, n, jx.data(), jy.data());
+
+    double max_rel = 0.0;
+    for (int i = 0; i < n; ++i) {
+        double ref_x = 0.0, ref_y = 0.0;
+        for (int j = 0; j < n; ++j) {
+            if (j == i || (store.family[i] >= 0 && store.family[j] == store.family[i])) continue;
+            const double dx = store.x[j] - store.x[i];
+            const double dy = store.y[j] - store.y[i];
+            const double dvx = store.vx[j] - store.vx[i];
+            const double dvy = store.vy[j] - store.vy[i];
+            const double d2 = std::max(dx * dx + dy * dy, 0.01);
+            const double factor = store.g_mass[j] / (d2 * std::sqrt(d2));
+            const double radial = 3.0 * (dx * dvx + dy * dvy) / d2;
+            ref_x += factor * (dvx - radial * dx);
+            ref_y += factor * (dvy - radial * dy);
+        }
+        max_rel = std::max(max_rel, std::hypot(jx[i] - ref_x, jy[i] - ref_y) / std::max(std::hypot(ref_x, ref_y), 1e-300));
+    }
+
+    std::cout << "Family jerk: largest relative error " << std::scientific << std::setprecision(2) << max_rel << std::defaultfloat << std::endl;
+    return max_rel < 1e-12;
+}
+
 int main(int argc, char* argv[]) {
     try {
         // Default values
         int num_planets = 250;
         int num_particles = 15000;
         int iterations = 25;
+        GravitySolver solver = GravitySolver::DIRECT;
+        double theta = 0.5;
+        double fmm_theta = 0.6;
+        int fmm_order = 4;
+        bool accuracy = false;
+        bool symmetric_pairs = true;
+        GravityPrecision precision = GravityPrecision::DOUBLE;
+        bool block_timesteps = false;
+        bool encounter_subcycling = false;
+        bool continuous_collisions = true;
+        double neighbour_skin = 10.0;
+        int reorder_interval = 64;
+        double reorder_disorder = 0.2;
+        bool reorder_speedup = false;
+        double passive_mass = 0.0;
+        int worker_threads = 0;
+        bool autotune = true;
+        bool retune = false;
+        bool check_allocations = false;
+        bool check_jerk = false;
+        Integrator integrator = Integrator::LEAPFROG;
+        double integrator_drift = 0.0;      // > 0 runs the integrator comparison instead
 
         // Parse command line arguments
         for (int i = 1; i < argc; ++i) {
@@ -24,16 +434,142 @@ int main(int argc, char* argv[]) {
                 num_particles = std::atoi(argv[++i]);
             } else if ((arg == "--iterations" || arg == "-i") && i + 1 < argc) {
                 iterations = std::atoi(argv[++i]);
+            } else if ((arg == "--solver" || arg == "-s") && i + 1 < argc) {
+                const std::string name = argv[++i];
+                if (name == "direct") solver = GravitySolver::DIRECT;
+                else if (name == "barnes_hut" || name == "bh") solver = GravitySolver::BARNES_HUT;
+                else if (name == "fmm") solver = GravitySolver::FMM;
+                else {
+                    std::cerr << "Unknown solver: " << name << std::endl;
+                    return 1;
+                }
+            } else if ((arg == "--theta" || arg == "-t") && i + 1 < argc) {
+                theta = std::atof(argv[++i]);
+            } else if (arg == "--fmm-theta" && i + 1 < argc) {
+                fmm_theta = std::atof(argv[++i]);
+            } else if (arg == "--order" && i + 1 < argc) {
+                fmm_order = std::atoi(argv[++i]);
+            } else if (arg == "--accuracy") {
+                accuracy = true;
+            } else if (arg == "--no-symmetric") {
+                symmetric_pairs = false;
+            } else if (arg == "--block-timesteps") {
+                block_timesteps = true;
+            } else if (arg == "--encounter-subcycling") {
+                encounter_subcycling = true;
+            } else if (arg == "--no-ccd") {
+                continuous_collisions = false;
+            } else if (arg == "--skin" && i + 1 < argc) {
+                neighbour_skin = std::atof(argv[++i]);
+            } else if (arg == "--reorder-interval" && i + 1 < argc) {
+                reorder_interval = std::atoi(argv[++i]);
+            } else if (arg == "--reorder-disorder" && i + 1 < argc) {
+                reorder_disorder = std::atof(argv[++i]);
+            } else if (arg == "--reorder-speedup") {
+                reorder_speedup = true;
+            } else if (arg == "--passive-mass" && i + 1 < argc) {
+                passive_mass = std::atof(argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                worker_threads = std::atoi(argv[++i]);
+            } else if (arg == "--no-autotune") {
+                autotune = false;
+            } else if (arg == "--retune") {
+                retune = true;
+            } else if (arg == "--check-allocations") {
+                check_allocations = true;
+            } else if (arg == "--check-jerk") {
+                check_jerk = true;
+            } else if (arg == "--integrator" && i + 1 < argc) {
+                const std::string name = argv[++i];
+                if (name == "leapfrog") integrator = Integrator::LEAPFROG;
+                else if (name == "yoshida4") integrator = Integrator::YOSHIDA4;
+                else if (name == "hermite4") integrator = Integrator::HERMITE4;
+                else if (name == "wisdom_holman" || name == "wh") integrator = Integrator::WISDOM_HOLMAN;
+                else {
+                    std::cerr << "Unknown integrator: " << name << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--energy-drift" && i + 1 < argc) {
+                integrator_drift = std::atof(argv[++i]);
+            } else if (arg == "--precision" && i + 1 < argc) {
+                const std::string name = argv[++i];
+                if (name == "double") precision = GravityPrecision::DOUBLE;
+                else if (name == "mixed") precision = GravityPrecision::MIXED;
+                else {
+                    std::cerr << "Unknown precision: " << name << std::endl;
+                    return 1;
+                }
             }
         }
 
+        if (check_jerk)
+            return checkFamilyJerk() ? 0 : 1;
+
         // Initialize backend to satisfy TGUI requirements
         sf::RenderWindow dummy_window(sf::VideoMode(800, 600), "Benchmark Dummy");
         tgui::Gui gui{dummy_window};
 
-        std::cout << "Initializing benchmark with " << num_planets << " planets..." << std::endl;
+        if (integrator_drift > 0.0) {
+            reportIntegratorDrift(integrator_drift, solver);
+            return 0;
+        }
+
+        std::string solver_name = "direct";
+        if (precision == GravityPrecision::MIXED) solver_name += ", mixed precision";
+        else if (symmetric_pairs) solver_name += ", symmetric pairs";
+        if (solver == GravitySolver::BARNES_HUT) solver_name = "Barnes-Hut, theta " + std::to_string(theta);
+        if (solver == GravitySolver::FMM) solver_name = "FMM, order " + std::to_string(fmm_order) + ", theta " + std::to_string(fmm_theta);
+        std::cout << "Initializing benchmark with " << num_planets << " planets (" << solver_name << ")..." << std::endl;
+        std::cout << "Pair kernel instruction set: " << PairKernel::instructionSet() << std::endl;
+        TaskPool::global().setThreadCount(worker_threads);
+        std::cout << "Worker threads: " << TaskPool::global().threadCount() << std::endl;
+        if (solver == GravitySolver::DIRECT && precision == GravityPrecision::DOUBLE && symmetric_pairs &&
+            !SymmetricPairKernel::balances(num_planets, TaskPool::global().threadCount()))
+            std::cout << "Too few tile pairs per thread for the symmetric kernel, the direct sum runs one-sided" << std::endl;
+        if (retune && autotune)
+            ParallelTuning::global().recalibrate();
+        ParallelTuning::global().update(autotune);
+        std::cout << "Loop schedules (" << (ParallelTuning::global().calibrated() ? "measured" : "defaults") << "):";
+        for (int l = 0; l < static_cast<int>(ParallelLoop::COUNT); ++l) {
+            const auto& schedule = ParallelTuning::global().schedule(static_cast<ParallelLoop>(l));
+            std::cout << " " << ParallelTuning::loopName(static_cast<ParallelLoop>(l)) << " from " << schedule.min_parallel << " by " << schedule.grain;
+        }
+        std::cout << std::endl;
+
+        const auto configure = [&](Space& space) {
+            space.config.gravity_solver = solver;
+            space.config.symmetric_pairs = symmetric_pairs;
+            space.config.gravity_precision = precision;
+            space.config.block_timesteps = block_timesteps;
+            space.config.encounter_subcycling = encounter_subcycling;
+            space.config.continuous_collisions = continuous_collisions;
+            space.config.neighbour_skin = neighbour_skin;
+            space.config.reorder_interval = reorder_interval;
+            space.config.reorder_disorder = reorder_disorder;
+            space.config.passive_mass = passive_mass;
+            space.config.worker_threads = worker_threads;
+            space.config.parallel_autotune = autotune;
+            space.config.integrator = integrator;
+            space.config.barnes_hut_theta = theta;
+            space.config.fmm_theta = fmm_theta;
+            space.config.fmm_order = fmm_order;
+        };
+
+        if (reorder_speedup) {
+            reportReorderSpeedup(num_planets, num_particles, iterations, configure);
+            return 0;
+        }
+
+        if (check_allocations) {
+            if (!AllocationCounter::enabled) {
+                std::cerr << "Counting allocations needs a debug build" << std::endl;
+                return 1;
+            }
+            return reportSteadyAllocations(num_planets, num_particles, iterations, configure) ? 0 : 1;
+        }
 
         Space space;
+        configure(space);
         
         for (int i = 0; i < num_planets; ++i) {
             double mass = 100.0 + (i % 10) * 10.0;
@@ -47,6 +583,12 @@ int main(int argc, char* argv[]) {
         
         space.flushPlanets(); 
 
+        if (accuracy) {
+            reportSolverAccuracy(space.getPlanets(), theta, fmm_theta);
+            reportPrecisionAccuracy(space.getPlanets());
+            return 0;
+        }
+
         std::cout << "Adding " << num_particles << " particles..." << std::endl;
         for (int i = 0; i < num_particles; ++i) {
             double x = (i % 100) * 50.0 - 2500.0;
@@ -72,8 +614,28 @@ int main(int argc, char* argv[]) {
         std::chrono::duration<double> elapsed = end - start;
         
         std::cout << "Time elapsed: " << elapsed.count() << " seconds" << std::endl;
-        if (iterations > 0)
+        if (iterations > 0) {
             std::cout << "Average time per iteration: " << (elapsed.count() / iterations) * 1000.0 << " ms" << std::endl;
+            std::cout << "Force evaluations per iteration: " << space.getForceEvaluations() / iterations
+                      << (block_timesteps ? " (block timesteps)" : "") << std::endl;
+            if (block_timesteps)
+                std::cout << "Time per 1000 force evaluations: "
+                          << 1000.0 * elapsed.count() * 1000.0 / std::max<size_t>(space.getForceEvaluations(), 1) << " ms" << std::endl;
+            if (encounter_subcycling)
+                std::cout << "Encounter substeps per iteration: " << space.getEncounterSubsteps() / iterations << std::endl;
+            std::cout << "Neighbour list rebuilds: " << space.getNeighbourListRebuilds() << std::endl;
+            std::cout << "Space-filling-curve sorts: " << space.getReorderSorts() << std::endl;
+            if (passive_mass > 0.0)
+                std::cout << "Passive bodies (last tick): " << space.getPassiveBodies() << std::endl;
+            const SystemAggregates& totals = space.getAggregates();
+            std::cout << "System totals: mass " << totals.mass
+                      << ", momentum (" << totals.momentum_x << ", " << totals.momentum_y << ")"
+                      << ", spin " << totals.spin()
+                      << ", energy " << totals.energy() << " (kinetic " << totals.kinetic << ", potential " << totals.potential << ")" << std::endl;
+        }
+
+        if (block_timesteps && iterations > 0)
+            reportBlockTimestepCost(num_planets, iterations, configure);
 
         std::cout << "Benchmarking rendering..." << std::endl;
         auto start_render = std::chrono::high_resolution_clock::now();
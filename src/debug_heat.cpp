@@ -25,8 +25,8 @@ int main() {
         
         space.flushPlanets(); 
 
-        Planet* pStar = space.findPlanetPtr(star_id);
-        Planet* pPlanet = space.findPlanetPtr(planet_id);
+        Planet* pStar = space.findPlanet(star_id);
+        Planet* pPlanet = space.findPlanet(planet_id);
 
         if (!pStar || !pPlanet) {
             std::cerr << "Failed to find planets!" << std::endl;
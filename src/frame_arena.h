@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+/*
+ * Scratch memory for one tick and the frame drawn after it.
+ *
+ * Containers on resource() (std::pmr::vector, std::pmr::map, ...) take their memory from a retained buffer
+ * by bumping a pointer, and giving it back is free. reset() hands the whole buffer out again, so nothing
+ * allocated from the arena may live past it. What does not fit in the buffer comes from the heap, and
+ * the next reset() grows the buffer by that much, so once the scratch of a tick fits no heap allocation
+ * is left. Not thread safe: parallel loops keep their scratch in ThreadBuffers.
+ */
+class FrameArena
+{
+public:
+	explicit FrameArena(size_t initial_bytes = 64 * 1024) : buffer(initial_bytes)
+	{
+		arena.emplace(buffer.data(), buffer.size(), &overflow);
+	}
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	[[nodiscard]] std::pmr::memory_resource* resource() noexcept { return &*arena; }
+
+	// Frees everything allocated since the last reset, growing the buffer if it overflowed
+	void reset()
+	{
+		if (overflow.bytes == 0)
+		{
+			arena->release();
+			return;
+		}
+
+		arena.reset();
+		buffer.resize(buffer.size() + overflow.bytes);
+		overflow.bytes = 0;
+		++grows;
+		arena.emplace(buffer.data(), buffer.size(), &overflow);
+	}
+
+	[[nodiscard]] size_t capacity() const noexcept { return buffer.size(); }
+	[[nodiscard]] size_t growCount() const noexcept { return grows; }
+
+private:
+	// Heap behind the buffer, counting what it hands out
+	struct Overflow : std::pmr::memory_resource
+	{
+		size_t bytes{ 0 };
+
+		void* do_allocate(size_t size, size_t alignment) override
+		{
+			bytes += size;
+			return std::pmr::new_delete_resource()->allocate(size, alignment);
+		}
+
+		void do_deallocate(void* p, size_t size, size_t alignment) override
+		{
+			std::pmr::new_delete_resource()->deallocate(p, size, alignment);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+	};
+
+	std::vector<std::byte> buffer;
+	Overflow overflow;
+	std::optional<std::pmr::monotonic_buffer_resource> arena;
+	size_t grows{ 0 };
+};
@@ -1,5 +1,6 @@
 #include "space.h"
 #include "StringConstants.h"
+#include "parallel_tuning.h"
 #include <fstream>
 #include <filesystem>
 #include <cstdlib>
@@ -46,11 +47,12 @@ namespace LauncherConfig
 
 void start(sf::RenderWindow& settingScreen, tgui::ListBox::Ptr resolutionList, tgui::ListBox::Ptr windowModeList, tgui::EditBox::Ptr customResX, tgui::EditBox::Ptr customResY);
 
-std::string getSettingsPath()
+// File in the Gravity-Simulator folder of APPDATA, or in the working directory if there is none
+std::string getAppDataPath(const std::string& name)
 {
 	const char* appData = std::getenv("APPDATA");
 	if (!appData)
-		return "settings.txt";
+		return name;
 
 	std::filesystem::path dir = std::filesystem::path(appData) / "Gravity-Simulator";
 
@@ -62,11 +64,16 @@ std::string getSettingsPath()
 		}
 		catch (...)
 		{
-			return "settings.txt";
+			return name;
 		}
 	}
 
-	return (dir / "settings.txt").string();
+	return (dir / name).string();
+}
+
+std::string getSettingsPath()
+{
+	return getAppDataPath("settings.txt");
 }
 
 void getPrevSettings(tgui::EditBox::Ptr& customResX, tgui::EditBox::Ptr& customResY, tgui::ListBox::Ptr& resolutionList, tgui::ListBox::Ptr& windowModeList)
@@ -223,6 +230,7 @@ void start(sf::RenderWindow& settingScreen, tgui::ListBox::Ptr resolutionList, t
 
 	settingScreen.close();
 
+	ParallelTuning::global().setCachePath(getAppDataPath("parallel_tuning.txt"));
 	Space space;
 	space.runSim({x, y}, fullscreen);
 	exit(0);
@@ -306,6 +314,7 @@ void runDirect(int width, int height, bool fullscreen, int udp_port = 0)
     tempWin.create(sf::VideoMode(1, 1), "", sf::Style::None);
     tgui::Gui tempGui{tempWin};
 
+    ParallelTuning::global().setCachePath(getAppDataPath("parallel_tuning.txt"));
     Space space;
     tempWin.close();
     space.runSim({width, height}, fullscreen, udp_port);
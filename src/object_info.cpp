@@ -107,8 +107,8 @@ void ObjectInfo::setup(Space& space, tgui::Gui& gui)
 	addRow("Name:", nameBox, false);
 	nameBox->onReturnKeyPress([this](const tgui::String& val) {
 		if (m_space && target_id != -1) {
-			if (auto* p = m_space->findPlanetPtr(target_id)) {
-				p->setName(val.toStdString());
+			if (m_space->findPlanet(target_id)) {
+				m_space->setPlanetName(target_id, val.toStdString());
 			}
 		}
 	});
@@ -116,7 +116,7 @@ void ObjectInfo::setup(Space& space, tgui::Gui& gui)
 	addRow("Mass:", massBox);
 	massBox->onReturnKeyPress([this](const tgui::String& val) {
 		if (m_space && target_id != -1) {
-			if (auto* p = m_space->findPlanetPtr(target_id)) {
+			if (auto* p = m_space->findPlanet(target_id)) {
 				try {
 					p->setMass(std::stod(val.toStdString()));
 					p->updateRadiAndType(); // Update radius and type based on mass
@@ -128,7 +128,7 @@ void ObjectInfo::setup(Space& space, tgui::Gui& gui)
 	addRow("Temp (K):", tempBox);
 	tempBox->onReturnKeyPress([this](const tgui::String& val) {
 		if (m_space && target_id != -1) {
-			if (auto* p = m_space->findPlanetPtr(target_id)) {
+			if (auto* p = m_space->findPlanet(target_id)) {
 				try {
 					p->setTemp(std::stod(val.toStdString()));
 				} catch (...) {}
@@ -139,11 +139,10 @@ void ObjectInfo::setup(Space& space, tgui::Gui& gui)
 	addRow("Pos X:", xBox);
 	xBox->onReturnKeyPress([this](const tgui::String& val) {
 		if (m_space && target_id != -1) {
-			if (auto* p = m_space->findPlanetPtr(target_id)) {
+			if (auto motion = m_space->getPlanetMotion(target_id)) {
 				try {
-					sf::Vector2f pos = p->getPosition();
-					pos.x = std::stod(val.toStdString());
-					p->setPosition(pos);
+					motion->x = std::stod(val.toStdString());
+					m_space->setPlanetMotion(target_id, *motion);
 				} catch (...) {}
 			}
 		}
@@ -152,11 +151,10 @@ void ObjectInfo::setup(Space& space, tgui::Gui& gui)
 	addRow("Pos Y:", yBox);
 	yBox->onReturnKeyPress([this](const tgui::String& val) {
 		if (m_space && target_id != -1) {
-			if (auto* p = m_space->findPlanetPtr(target_id)) {
+			if (auto motion = m_space->getPlanetMotion(target_id)) {
 				try {
-					sf::Vector2f pos = p->getPosition();
-					pos.y = std::stod(val.toStdString());
-					p->setPosition(pos);
+					motion->y = std::stod(val.toStdString());
+					m_space->setPlanetMotion(target_id, *motion);
 				} catch (...) {}
 			}
 		}
@@ -165,11 +163,10 @@ void ObjectInfo::setup(Space& space, tgui::Gui& gui)
 	addRow("Vel X:", vxBox);
 	vxBox->onReturnKeyPress([this](const tgui::String& val) {
 		if (m_space && target_id != -1) {
-			if (auto* p = m_space->findPlanetPtr(target_id)) {
+			if (auto motion = m_space->getPlanetMotion(target_id)) {
 				try {
-					sf::Vector2f vel = p->getVelocity();
-					vel.x = std::stod(val.toStdString());
-					p->setVelocity(vel);
+					motion->vx = std::stod(val.toStdString());
+					m_space->setPlanetMotion(target_id, *motion);
 				} catch (...) {}
 			}
 		}
@@ -178,11 +175,10 @@ void ObjectInfo::setup(Space& space, tgui::Gui& gui)
 	addRow("Vel Y:", vyBox);
 	vyBox->onReturnKeyPress([this](const tgui::String& val) {
 		if (m_space && target_id != -1) {
-			if (auto* p = m_space->findPlanetPtr(target_id)) {
+			if (auto motion = m_space->getPlanetMotion(target_id)) {
 				try {
-					sf::Vector2f vel = p->getVelocity();
-					vel.y = std::stod(val.toStdString());
-					p->setVelocity(vel);
+					motion->vy = std::stod(val.toStdString());
+					m_space->setPlanetMotion(target_id, *motion);
 				} catch (...) {}
 			}
 		}
@@ -191,7 +187,7 @@ void ObjectInfo::setup(Space& space, tgui::Gui& gui)
 	addRow("Atmo:", atmoBox);
 	atmoBox->onReturnKeyPress([this](const tgui::String& val) {
 		if (m_space && target_id != -1) {
-			if (auto* p = m_space->findPlanetPtr(target_id)) {
+			if (auto* p = m_space->findPlanet(target_id)) {
 				try {
 					p->setAtmosphere(std::stod(val.toStdString()));
 				} catch (...) {}
@@ -202,7 +198,7 @@ void ObjectInfo::setup(Space& space, tgui::Gui& gui)
 	addRow("Atmo Pot:", atmoPotBox);
 	atmoPotBox->onReturnKeyPress([this](const tgui::String& val) {
 		if (m_space && target_id != -1) {
-			if (auto* p = m_space->findPlanetPtr(target_id)) {
+			if (auto* p = m_space->findPlanet(target_id)) {
 				try {
 					p->setAtmospherePotensial(std::stod(val.toStdString()));
 				} catch (...) {}
@@ -231,7 +227,7 @@ void ObjectInfo::setup(Space& space, tgui::Gui& gui)
 	lifeLevelSelector->addItem("Colony");
 	lifeLevelSelector->onItemSelect([this](const tgui::String& item) {
 		if (m_space && target_id != -1 && !ignore_change_signals) {
-			if (auto* p = m_space->findPlanetPtr(target_id)) {
+			if (auto* p = m_space->findPlanet(target_id)) {
 				if (item == "Lifeless") p->setLifeLevel(lType::NONE);
 				else if (item == "Unicellular") p->setLifeLevel(lType::SINGLECELL);
 				else if (item == "Multicellular (S)") p->setLifeLevel(lType::MULTICELL_SIMPLE);
@@ -283,13 +279,13 @@ void ObjectInfo::update_ui_values(Space& space, sf::RenderWindow& window)
 {
 	if (target_id == -1 || !panel || !panel->isVisible()) return;
 
-	Planet* target = space.findPlanetPtr(target_id);
+	Planet* target = space.findPlanet(target_id);
 	if (!target) {
 		deactivate();
 		return;
 	}
 
-	if (!nameBox->isFocused()) nameBox->setText(target->getName());
+	if (!nameBox->isFocused()) nameBox->setText(space.getPlanetName(target_id));
 	if (!massBox->isFocused()) massBox->setText(d2s(target->getMass()));
 	if (!tempBox->isFocused()) tempBox->setText(d2s(target->getTemp()));
 	if (!xBox->isFocused()) xBox->setText(d2s(target->getx()));
@@ -317,19 +313,19 @@ void ObjectInfo::update_info_text()
 {
 	if (!m_infoLabel || !m_space || target_id == -1) return;
 
-	Planet* target = m_space->findPlanetPtr(target_id);
+	Planet* target = m_space->findPlanet(target_id);
 	if (!target) return;
 
 	const auto selected_temp_unit = static_cast<TemperatureUnit>(m_space->temperatureUnitSelector->getSelectedIndex());
 
-	std::string info = target->getName() +
+	std::string info = m_space->getPlanetName(target_id) +
 		"\nType: " + target->getDisplayName() +
 		"\nRadius: " + std::to_string(static_cast<int>(target->getRadius())) +
 		"\nMass: " + std::to_string(static_cast<int>(target->getMass())) +
 		"\nSpeed: " + ([&]() { std::ostringstream s; s << std::fixed << std::setprecision(2) << std::hypot(target->getxv(), target->getyv()); return s.str(); })() +
 		"\nTemperature: " + Space::temperature_info_string(target->getTemp(), selected_temp_unit);
 
-	Planet* target_parent = m_space->findPlanetPtr(target->getStrongestAttractorId());
+	Planet* target_parent = m_space->findPlanet(target->getStrongestAttractorId());
 	if (target_parent)
 		info += "\nDistance: " + std::to_string(static_cast<int>(std::hypot(target->getx() - target_parent->getx(),
 			target->gety() - target_parent->gety())));
@@ -366,7 +362,7 @@ void ObjectInfo::update_info_text()
 
 void ObjectInfo::render(Space& space, sf::RenderWindow& window)
 {
-	Planet* target = space.findPlanetPtr(target_id);
+	Planet* target = space.findPlanet(target_id);
 	if (!target)
 	{
 		deactivate();
@@ -421,7 +417,7 @@ void ObjectInfo::render(Space& space, sf::RenderWindow& window)
 		window.draw(g);
 	}
 
-	Planet* target_parent = space.findPlanetPtr(target->getStrongestAttractorId());
+	Planet* target_parent = space.findPlanet(target->getStrongestAttractorId());
 	if (target_parent)
 	{
 		sf::Vertex g[] =
@@ -37,7 +37,7 @@ void ObjectTracker::update(Space& space, sf::View& view)
         return;
     }
 
-	Planet* target = space.findPlanetPtr(target_id);
+	Planet* target = space.findPlanet(target_id);
 	if (!target)
 	{
 		deactivate();
@@ -0,0 +1,262 @@
+#include "parallel_tuning.h"
+
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr int CACHE_VERSION = 1;
+
+// Loop sizes and grains tried by the calibration
+constexpr int SIZES[] = { 16, 64, 256, 1024, 4096, 16384, 65536 };
+constexpr int GRAINS[] = { 16, 64, 256, 1024, 4096 };
+constexpr int N_SIZES = static_cast<int>(std::size(SIZES));
+constexpr int N_GRAINS = static_cast<int>(std::size(GRAINS));
+
+// The pool counts as faster once it beats the serial loop by this factor
+constexpr double WIN_FACTOR = 0.9;
+
+// Planets of the PARTICLE stand-in, about what that loop sees per iteration
+constexpr int PARTICLE_PLANETS = 8;
+
+constexpr int NEVER_PARALLEL = INT_MAX;
+
+// Fastest of three rounds, each repeating the call for at least 50 us
+template <typename Fn>
+double secondsPerCall(Fn&& fn)
+{
+	using clock = std::chrono::steady_clock;
+	double best = 1e30;
+	for (int round = 0; round < 3; ++round)
+	{
+		const auto start = clock::now();
+		int calls = 0;
+		double elapsed = 0.0;
+		do
+		{
+			fn();
+			++calls;
+			elapsed = std::chrono::duration<double>(clock::now() - start).count();
+		} while (elapsed < 50e-6);
+		best = std::min(best, elapsed / calls);
+	}
+	return best;
+}
+
+// Stand-ins for the loop kinds, each touching arrays the size of the largest loop
+struct Workload
+{
+	std::vector<double> x, v, a;
+	std::vector<float> px, py, temp;
+
+	explicit Workload(int n) : x(n, 1.0), v(n, 0.5), a(n, 0.25), px(n, 1.0f), py(n, 2.0f), temp(n, 300.0f) {}
+
+	void bodyUpdate(int i)
+	{
+		v[i] += a[i] * 1e-3;
+		x[i] += v[i] * 1e-3;
+	}
+
+	void bodyForce(int i)
+	{
+		double ax = 0.0, ay = 0.0;
+		for (int j = 0; j < ParallelTuning::FORCE_ROW; ++j)
+		{
+			const double dx = j - x[i];
+			const double dy = 0.5 * j - v[i];
+			const double d2 = dx * dx + dy * dy + 0.01;
+			const double f = 1.0 / (d2 * std::sqrt(d2));
+			ax += f * dx;
+			ay += f * dy;
+		}
+		a[i] = ax + ay;
+	}
+
+	void particle(int i)
+	{
+		float ax = 0.0f, heat = 0.0f;
+		for (int j = 0; j < PARTICLE_PLANETS; ++j)
+		{
+			const float dx = 100.0f * j - px[i];
+			const float dy = 50.0f * j - py[i];
+			const float d2 = dx * dx + dy * dy + 1.0f;
+			ax += dx / (d2 * std::sqrt(d2));
+			heat += 1.0f / std::sqrt(d2);
+		}
+		px[i] += ax * 1e-3f;
+		temp[i] = 0.99f * temp[i] + heat;
+	}
+};
+
+template <typename Body>
+TaskPool::Schedule measure(TaskPool& pool, Body&& body)
+{
+	double serial[N_SIZES];
+	double parallel[N_SIZES][N_GRAINS];
+	for (int s = 0; s < N_SIZES; ++s)
+	{
+		const int n = SIZES[s];
+		serial[s] = secondsPerCall([&] { for (int i = 0; i < n; ++i) body(i); });
+		for (int g = 0; g < N_GRAINS; ++g)
+			parallel[s][g] = GRAINS[g] >= n ? serial[s] : secondsPerCall([&] { pool.parallelFor(0, n, GRAINS[g], body); });
+	}
+
+	// The grain with the lowest time relative to the serial loop, summed over the sizes
+	int best_grain = 0;
+	double best_score = 1e30;
+	for (int g = 0; g < N_GRAINS; ++g)
+	{
+		double score = 0.0;
+		for (int s = 0; s < N_SIZES; ++s)
+			score += parallel[s][g] / serial[s];
+		if (score < best_score)
+		{
+			best_score = score;
+			best_grain = g;
+		}
+	}
+
+	// Smallest size from which the pool wins at every larger size
+	int min_parallel = NEVER_PARALLEL;
+	for (int s = N_SIZES - 1; s >= 0 && parallel[s][best_grain] < WIN_FACTOR * serial[s]; --s)
+		min_parallel = SIZES[s];
+	return { min_parallel, GRAINS[best_grain] };
+}
+
+}
+
+ParallelTuning& ParallelTuning::global()
+{
+	static ParallelTuning tuning;
+	return tuning;
+}
+
+const char* ParallelTuning::loopName(ParallelLoop loop)
+{
+	switch (loop)
+	{
+	case ParallelLoop::BODY_UPDATE: return "body_update";
+	case ParallelLoop::BODY_FORCE: return "body_force";
+	case ParallelLoop::PARTICLE: return "particle";
+	default: return "unknown";
+	}
+}
+
+ParallelTuning::Schedules ParallelTuning::defaults()
+{
+	Schedules schedules;
+	schedules[static_cast<int>(ParallelLoop::BODY_UPDATE)] = { 64, 0 };
+	schedules[static_cast<int>(ParallelLoop::BODY_FORCE)] = { 64, 64 };
+	schedules[static_cast<int>(ParallelLoop::PARTICLE)] = { 500, 0 };
+	return schedules;
+}
+
+ParallelTuning::Schedules ParallelTuning::calibrate(TaskPool& pool)
+{
+	Workload workload(SIZES[N_SIZES - 1]);
+	Schedules schedules;
+	schedules[static_cast<int>(ParallelLoop::BODY_UPDATE)] = measure(pool, [&](int i) { workload.bodyUpdate(i); });
+	schedules[static_cast<int>(ParallelLoop::BODY_FORCE)] = measure(pool, [&](int i) { workload.bodyForce(i); });
+	schedules[static_cast<int>(ParallelLoop::PARTICLE)] = measure(pool, [&](int i) { workload.particle(i); });
+	return schedules;
+}
+
+void ParallelTuning::setCachePath(std::string path)
+{
+	cache_path = std::move(path);
+	cache_loaded = false;
+}
+
+void ParallelTuning::update(bool autotune)
+{
+	TaskPool& pool = TaskPool::global();
+	const int threads = pool.threadCount();
+
+	// One thread runs every loop inline, there is nothing to tune
+	using_measured = autotune && threads > 1;
+	if (!using_measured)
+	{
+		current = defaults();
+		return;
+	}
+
+	if (!cache_loaded)
+		load();
+
+	auto entry = measured.find(threads);
+	if (entry == measured.end())
+	{
+		entry = measured.emplace(threads, calibrate(pool)).first;
+		save();
+	}
+	current = entry->second;
+}
+
+void ParallelTuning::recalibrate()
+{
+	if (!cache_loaded)
+		load();
+	measured.erase(TaskPool::global().threadCount());
+	update(true);
+}
+
+/*
+ * One line per thread count: "threads <n>" then "<loop> <min_parallel> <grain>" for every loop. The
+ * header records the format version and the hardware thread count, a cache from other hardware is ignored.
+ */
+void ParallelTuning::load()
+{
+	cache_loaded = true;
+	measured.clear();
+
+	std::ifstream file(cache_path);
+	if (file.fail())
+		return;
+
+	std::string tag;
+	int version = 0;
+	unsigned hardware = 0;
+	if (!(file >> tag >> version >> hardware) || tag != "version" || version != CACHE_VERSION || hardware != std::thread::hardware_concurrency())
+		return;
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		std::istringstream in(line);
+		int threads = 0;
+		if (!(in >> tag >> threads) || tag != "threads" || threads < 1)
+			continue;
+
+		Schedules schedules = defaults();
+		bool complete = true;
+		for (int l = 0; l < static_cast<int>(ParallelLoop::COUNT); ++l)
+		{
+			TaskPool::Schedule& schedule = schedules[l];
+			complete = complete && (in >> tag >> schedule.min_parallel >> schedule.grain) && tag == loopName(static_cast<ParallelLoop>(l));
+		}
+		if (complete)
+			measured[threads] = schedules;
+	}
+}
+
+void ParallelTuning::save() const
+{
+	std::ofstream file(cache_path);
+	if (file.fail())
+		return;
+
+	file << "version " << CACHE_VERSION << " " << std::thread::hardware_concurrency() << "\n";
+	for (const auto& [threads, schedules] : measured)
+	{
+		file << "threads " << threads;
+		for (int l = 0; l < static_cast<int>(ParallelLoop::COUNT); ++l)
+			file << " " << loopName(static_cast<ParallelLoop>(l)) << " " << schedules[l].min_parallel << " " << schedules[l].grain;
+		file << "\n";
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <string>
+
+#include "task_pool.h"
+
+// Kinds of parallel loop, by cost per iteration
+enum class ParallelLoop
+{
+	BODY_UPDATE,	// a few flops per body: kicks, drifts, predictor and corrector, heat scaling
+	BODY_FORCE,		// a row of pair terms or a tree walk per body
+	PARTICLE,		// a particle against the cached planets, removal tests
+	COUNT
+};
+
+/*
+ * Schedules of the parallel loops measured on this machine: below how many iterations a loop runs
+ * serially, and how many iterations each chunk takes.
+ *
+ * calibrate() times a stand-in for each kind of loop serially and on the pool, at sizes from 16 to 65536
+ * and at several grains, and keeps the grain that wins over the most sizes and the size from which
+ * the pool keeps winning with it. The results depend on the thread count, so they are kept per count
+ * and cached in a text file; a count not in the cache is calibrated the first time it is used, which
+ * takes a fraction of a second. With autotuning off, or before calibration, the fixed defaults apply.
+ */
+class ParallelTuning
+{
+public:
+	static ParallelTuning& global();
+
+	// Cache file, read on the next update(). Defaults to parallel_tuning.txt in the working directory.
+	void setCachePath(std::string path);
+
+	/*
+	 * Selects the schedules for the current thread count of TaskPool::global(), calibrating and saving them
+	 * first if they are not cached. Called between ticks.
+	 */
+	void update(bool autotune);
+
+	// Forgets the cached schedules of the current thread count and measures them again
+	void recalibrate();
+
+	[[nodiscard]] const TaskPool::Schedule& schedule(ParallelLoop loop) const noexcept { return current[static_cast<int>(loop)]; }
+	[[nodiscard]] bool calibrated() const noexcept { return using_measured; }
+
+	[[nodiscard]] static const char* loopName(ParallelLoop loop);
+
+	// Pair terms per iteration of the BODY_FORCE stand-in, for loops that scale the schedule to their own row length
+	static constexpr int FORCE_ROW = 64;
+
+private:
+	using Schedules = std::array<TaskPool::Schedule, static_cast<int>(ParallelLoop::COUNT)>;
+
+	static Schedules defaults();
+	static Schedules calibrate(TaskPool& pool);
+
+	void load();
+	void save() const;
+
+	std::string cache_path{ "parallel_tuning.txt" };
+	bool cache_loaded{ false };
+	std::map<int, Schedules> measured;		// by thread count
+	Schedules current{ defaults() };
+	bool using_measured{ false };
+};
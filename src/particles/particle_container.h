@@ -4,15 +4,22 @@
 #include <SFML/Graphics.hpp>
 #include <cmath>
 
+#include "../physics/spatial_index.h"
+#include "../physics/morton_order.h"
+#include "../task_pool.h"
+#include "../parallel_tuning.h"
+
 class IParticleContainer
 {
 public:
 	~IParticleContainer() = default;
-	virtual void update(const std::vector<Planet> & planets, const Bound &bound, double timestep, double curr_time, bool gravity_enabled, bool heat_enabled) = 0;
+	virtual void update(const std::vector<Planet> & planets, const SpatialIndex & planet_index, const Bound &bound, double timestep, double curr_time, bool gravity_enabled, bool heat_enabled) = 0;
 	virtual void render_all(sf::RenderTarget &w) = 0;
 	virtual void add_particle(const sf::Vector2f& position, const sf::Vector2f& velocity, double size, double removal_time, double initial_temp, bool ice = false) = 0;
 	virtual void clear() = 0;
 	virtual size_t size() const = 0;
+	// Sorts the particles along a space-filling curve if more than max_disorder of them are out of its order
+	virtual void reorder(double max_disorder) = 0;
 };
 
 
@@ -36,6 +43,22 @@ class DecimatedLegacyParticleContainer : public IParticleContainer
 	sf::Texture circle_texture;
 	bool texture_initialized{ false };
 
+	MortonOrder morton_order;
+	std::vector<LegacyParticle> reorder_scratch;
+
+	// Removal flags of the update, and the chunks and glow sizes of the vertex building, kept between frames
+	std::vector<char> remove_flags;
+	struct RenderChunk
+	{
+		const std::vector<LegacyParticle>* source;
+		int begin, end;
+		size_t first;		// index of the chunk's first particle over all vectors
+		size_t first_glow;
+		size_t glows;
+	};
+	std::vector<RenderChunk> render_chunks;
+	std::vector<float> glow_radius;		// -1 for particles without a glow
+
 	size_t current_dec_simulation_target{ 0 };
 	void next_dec_simulation_target()
 	{
@@ -69,108 +92,72 @@ public:
 
 	struct CachedPlanet {
 		float x, y;
-		double mass, g_mass, radius, radius_sq;
+		double mass, g_mass;
 		double thermal_energy;
 		bool emits_heat;
-		bool grace_active;
 	};
 
-	void update(const std::vector<Planet>& planets, const Bound& bound, double timestep, double curr_time, bool gravity_enabled, bool heat_enabled) override
+	void update(const std::vector<Planet>& planets, const SpatialIndex& planet_index, const Bound& bound, double timestep, double curr_time, bool gravity_enabled, bool heat_enabled) override
 	{
 		next_dec_simulation_target();
 
 		// Pre-filter and cache planet data for particle physics
-		std::vector<CachedPlanet> cached;
-		cached.reserve(planets.size());
+		cached_planets.clear();
 		for (const auto& planet : planets)
 		{
 			if (planet.getMass() < DUST_MIN_PHYSICS_SIZE) continue;
-			cached.push_back({
+			cached_planets.push_back({
 				planet.getx(), planet.gety(),
 				planet.getMass(), G * planet.getMass(),
-				planet.getRadius(), planet.getRadius() * planet.getRadius(),
 				(heat_enabled && planet.emitsHeat()) ? planet.giveThermalEnergy(timestep * decimation_factor) : 0.0,
-				planet.emitsHeat(),
-				planet.disintegrationGraceTimeIsActive(curr_time)
+				planet.emitsHeat()
 			});
 		}
 
-		auto& target_particles = particles[current_dec_simulation_target];
-
-		#pragma omp parallel for if(target_particles.size() > 500u)
-		for (int i = 0; i < (int)target_particles.size(); ++i)
-		{
-			auto& particle = target_particles[i];
-
-			for (const auto& cp : cached)
-			{
-				const auto curr_pos = particle.get_position();
-
-				const auto dx = cp.x - curr_pos.x;
-				const auto dy = cp.y - curr_pos.y;
-				const auto distanceSquared = dx * dx + dy * dy;
-
-				double dist = 1.0;
-				bool dist_calculated = false;
-
-				if (heat_enabled && cp.thermal_energy > 0)
-				{
-					dist = std::max(static_cast<double>(std::sqrt(distanceSquared)), 1.0);
-					dist_calculated = true;
-
-					double heat = calculate_heating(particle.get_radius(), cp.thermal_energy, dist);
-					particle.absorb_heat(heat);
-				}
-
-				if (gravity_enabled)
-				{
-					double real_dist;
-					if (dist_calculated)
-						real_dist = dist;
-					else
-						real_dist = std::sqrt(distanceSquared);
-
-					if (real_dist < 0.1) real_dist = 0.1;
-
-					const double r3 = real_dist * real_dist * real_dist;
-					const double A_div_r3 = cp.g_mass / r3;
-
-					const auto acceleration = sf::Vector2f(
-						static_cast<float>(A_div_r3 * dx),
-						static_cast<float>(A_div_r3 * dy)
-					);
-
-					const auto dv = static_cast<float>(timestep) * static_cast<float>(decimation_factor) * acceleration;
-					particle.set_velocity(particle.get_velocity() + dv);
-				}
-			}
-
-			particle.cool_down(timestep * decimation_factor);
-		}
+		// Loop compiled for this tick's gravity and heat flags, indexed by gravity * 2 + heat
+		static constexpr SimulateFn simulate_loops[] = {
+			&DecimatedLegacyParticleContainer::simulate<false, false>, &DecimatedLegacyParticleContainer::simulate<false, true>,
+			&DecimatedLegacyParticleContainer::simulate<true, false>, &DecimatedLegacyParticleContainer::simulate<true, true>
+		};
+		(this->*simulate_loops[(gravity_enabled ? 2 : 0) + (heat_enabled ? 1 : 0)])(particles[current_dec_simulation_target], cached_planets, timestep);
 
+		// Particles move and are tested for removal in parallel, then compacted in order
 		for (auto& particle_vector : particles)
 		{
-			std::erase_if(particle_vector, [&](auto& particle) {
-				if (particle.to_be_removed(curr_time)) return true;
-
-				particle.move(timestep);
+			const int n = static_cast<int>(particle_vector.size());
+			remove_flags.resize(n);
+			TaskPool::global().parallelFor(0, n, ParallelTuning::global().schedule(ParallelLoop::PARTICLE), [&](int i) {
+				auto& particle = particle_vector[i];
+				remove_flags[i] = [&] {
+					if (particle.to_be_removed(curr_time)) return true;
 
-				if (bound.isActive() && bound.isOutside(particle.get_position()))
-					return true;
+					particle.move(timestep);
 
-				for (const auto& cp : cached)
-				{
-					const float dx = cp.x - particle.get_position().x;
-					const float dy = cp.y - particle.get_position().y;
-					const float distanceSquared = dx * dx + dy * dy;
-
-					if (distanceSquared <= cp.radius_sq && !cp.grace_active)
-					{
+					if (bound.isActive() && bound.isOutside(particle.get_position()))
 						return true;
-					}
-				}
-				return false;
+
+					// Absorbed by a planet heavy enough to act on dust
+					bool absorbed = false;
+					planet_index.queryCircle(particle.get_position().x, particle.get_position().y, 0.0, [&](const SpatialIndex::Entry& e) {
+						const Planet& planet = planets[e.item];
+						if (absorbed || planet.getMass() < DUST_MIN_PHYSICS_SIZE || planet.disintegrationGraceTimeIsActive(curr_time)) return;
+						const float dx = planet.getx() - particle.get_position().x;
+						const float dy = planet.gety() - particle.get_position().y;
+						absorbed = dx * dx + dy * dy <= planet.getRadius() * planet.getRadius();
+					});
+					return absorbed;
+				}();
 			});
+
+			int kept = 0;
+			for (int i = 0; i < n; ++i)
+			{
+				if (remove_flags[i]) continue;
+				if (kept != i)
+					particle_vector[kept] = std::move(particle_vector[i]);
+				++kept;
+			}
+			particle_vector.erase(particle_vector.begin() + kept, particle_vector.end());
 		}
 	}
 
@@ -178,42 +165,88 @@ public:
 	{
         if (!texture_initialized) init_texture();
 
-		body_vertices.clear();
-		glow_vertices.clear();
+		// Vertices are built in parallel chunks of the particle schedule's grain: body quads at fixed offsets,
+		// glow quads at offsets counted per chunk in the first pass
+		TaskPool& pool = TaskPool::global();
+		const TaskPool::Schedule& schedule = ParallelTuning::global().schedule(ParallelLoop::PARTICLE);
+		size_t total = 0;
+		for (const auto& particle_vector : particles)
+			total += particle_vector.size();
+		const int render_chunk = schedule.grain > 0 ? schedule.grain : pool.autoGrain(static_cast<int>(total));
+		const TaskPool::Schedule chunk_schedule{ schedule.perBlock(render_chunk).min_parallel, 1 };
 
+		render_chunks.clear();
+		total = 0;
 		for (const auto& particle_vector : particles)
 		{
-			for (const auto& particle : particle_vector)
+			const int n = static_cast<int>(particle_vector.size());
+			for (int begin = 0; begin < n; begin += render_chunk)
+				render_chunks.push_back({ &particle_vector, begin, std::min(begin + render_chunk, n), total + begin, 0, 0 });
+			total += n;
+		}
+		body_vertices.resize(4 * total);
+		glow_radius.resize(total);
+
+		const int n_chunks = static_cast<int>(render_chunks.size());
+		pool.parallelFor(0, n_chunks, chunk_schedule, [&](int c) {
+			RenderChunk& chunk = render_chunks[c];
+			for (int i = chunk.begin; i < chunk.end; ++i)
 			{
+				const auto& particle = (*chunk.source)[i];
+				const size_t k = chunk.first + (i - chunk.begin);
 				sf::Vector2f pos = particle.get_position();
 				float r = static_cast<float>(particle.get_render_radius());
 				sf::Color col = particle.get_color();
 
 				// Body Quad
-				body_vertices.append(sf::Vertex(sf::Vector2f(pos.x - r, pos.y - r), col, sf::Vector2f(0, 0)));
-				body_vertices.append(sf::Vertex(sf::Vector2f(pos.x + r, pos.y - r), col, sf::Vector2f(32, 0)));
-				body_vertices.append(sf::Vertex(sf::Vector2f(pos.x + r, pos.y + r), col, sf::Vector2f(32, 32)));
-				body_vertices.append(sf::Vertex(sf::Vector2f(pos.x - r, pos.y + r), col, sf::Vector2f(0, 32)));
+				sf::Vertex* quad = &body_vertices[4 * k];
+				quad[0] = sf::Vertex(sf::Vector2f(pos.x - r, pos.y - r), col, sf::Vector2f(0, 0));
+				quad[1] = sf::Vertex(sf::Vector2f(pos.x + r, pos.y - r), col, sf::Vector2f(32, 0));
+				quad[2] = sf::Vertex(sf::Vector2f(pos.x + r, pos.y + r), col, sf::Vector2f(32, 32));
+				quad[3] = sf::Vertex(sf::Vector2f(pos.x - r, pos.y + r), col, sf::Vector2f(0, 32));
 
 				// Heat Glow
+				glow_radius[k] = -1.0f;
 				double temp = particle.get_temp();
 				if (temp > 500.0)
 				{
 					double glow_scale = std::sqrt(temp - 500.0) / 30.0;
 					if (glow_scale > 0.1)
 					{
-						float gr = static_cast<float>(r * glow_scale);
-                        // Using higher alpha because the texture has falloff now
-						sf::Color glow_col(255, 255, 255, 120);
-
-						glow_vertices.append(sf::Vertex(sf::Vector2f(pos.x - gr, pos.y - gr), glow_col, sf::Vector2f(0, 0)));
-						glow_vertices.append(sf::Vertex(sf::Vector2f(pos.x + gr, pos.y - gr), glow_col, sf::Vector2f(32, 0)));
-						glow_vertices.append(sf::Vertex(sf::Vector2f(pos.x + gr, pos.y + gr), glow_col, sf::Vector2f(32, 32)));
-						glow_vertices.append(sf::Vertex(sf::Vector2f(pos.x - gr, pos.y + gr), glow_col, sf::Vector2f(0, 32)));
+						glow_radius[k] = static_cast<float>(r * glow_scale);
+						++chunk.glows;
 					}
 				}
 			}
+		});
+
+		size_t n_glows = 0;
+		for (auto& chunk : render_chunks)
+		{
+			chunk.first_glow = n_glows;
+			n_glows += chunk.glows;
 		}
+		glow_vertices.resize(4 * n_glows);
+
+		pool.parallelFor(0, n_chunks, chunk_schedule, [&](int c) {
+			const RenderChunk& chunk = render_chunks[c];
+			size_t glow = chunk.first_glow;
+			for (int i = chunk.begin; i < chunk.end; ++i)
+			{
+				const float gr = glow_radius[chunk.first + (i - chunk.begin)];
+				if (gr < 0.0f) continue;
+
+				sf::Vector2f pos = (*chunk.source)[i].get_position();
+                // Using higher alpha because the texture has falloff now
+				sf::Color glow_col(255, 255, 255, 120);
+
+				sf::Vertex* quad = &glow_vertices[4 * glow++];
+				quad[0] = sf::Vertex(sf::Vector2f(pos.x - gr, pos.y - gr), glow_col, sf::Vector2f(0, 0));
+				quad[1] = sf::Vertex(sf::Vector2f(pos.x + gr, pos.y - gr), glow_col, sf::Vector2f(32, 0));
+				quad[2] = sf::Vertex(sf::Vector2f(pos.x + gr, pos.y + gr), glow_col, sf::Vector2f(32, 32));
+				quad[3] = sf::Vertex(sf::Vector2f(pos.x - gr, pos.y + gr), glow_col, sf::Vector2f(0, 32));
+			}
+		});
 
 		window.draw(glow_vertices, sf::RenderStates(&circle_texture));
 		window.draw(body_vertices, sf::RenderStates(&circle_texture));
@@ -240,6 +273,12 @@ public:
 			vector.clear();
 	}
 
+	void reorder(double max_disorder) override
+	{
+		for (auto& particle_vector : particles)
+			morton_order.reorder(particle_vector, [](const LegacyParticle& p) { return p.get_position(); }, max_disorder, reorder_scratch);
+	}
+
 	size_t size() const override
 	{
 		int total_size = std::accumulate(particles.begin(), particles.end(), 0, [](int sum, const auto& vec) {
@@ -247,4 +286,71 @@ public:
 			});
 		return total_size;
 	}
+
+private:
+
+	// Planet data of the update, kept between ticks
+	std::vector<CachedPlanet> cached_planets;
+
+	// Gravity and heat of the cached planets on one decimation slice
+	template <bool Gravity, bool Heat>
+	void simulate(std::vector<LegacyParticle>& target_particles, const std::vector<CachedPlanet>& cached, double timestep)
+	{
+		TaskPool::global().parallelFor(0, static_cast<int>(target_particles.size()), ParallelTuning::global().schedule(ParallelLoop::PARTICLE), [&](int i) {
+			auto& particle = target_particles[i];
+
+			if constexpr (Gravity || Heat)
+			{
+				for (const auto& cp : cached)
+				{
+					const auto curr_pos = particle.get_position();
+
+					const auto dx = cp.x - curr_pos.x;
+					const auto dy = cp.y - curr_pos.y;
+					const auto distanceSquared = dx * dx + dy * dy;
+
+					double dist = 1.0;
+					bool dist_calculated = false;
+
+					if constexpr (Heat)
+					{
+						if (cp.thermal_energy > 0)
+						{
+							dist = std::max(static_cast<double>(std::sqrt(distanceSquared)), 1.0);
+							dist_calculated = true;
+
+							double heat = calculate_heating(particle.get_radius(), cp.thermal_energy, dist);
+							particle.absorb_heat(heat);
+						}
+					}
+
+					if constexpr (Gravity)
+					{
+						double real_dist;
+						if (dist_calculated)
+							real_dist = dist;
+						else
+							real_dist = std::sqrt(distanceSquared);
+
+						if (real_dist < 0.1) real_dist = 0.1;
+
+						const double r3 = real_dist * real_dist * real_dist;
+						const double A_div_r3 = cp.g_mass / r3;
+
+						const auto acceleration = sf::Vector2f(
+							static_cast<float>(A_div_r3 * dx),
+							static_cast<float>(A_div_r3 * dy)
+						);
+
+						const auto dv = static_cast<float>(timestep) * static_cast<float>(decimation_factor) * acceleration;
+						particle.set_velocity(particle.get_velocity() + dv);
+					}
+				}
+			}
+
+			particle.cool_down(timestep * decimation_factor);
+		});
+	}
+
+	using SimulateFn = void (DecimatedLegacyParticleContainer::*)(std::vector<LegacyParticle>&, const std::vector<CachedPlanet>&, double);
 };
@@ -0,0 +1,167 @@
+#include "barnes_hut.h"
+
+#include <limits>
+
+void BarnesHutTree::build(const std::vector<Body>& source)
+{
+	bodies.assign(source.begin(), source.end());
+	nodes.clear();
+
+	if (bodies.empty())
+		return;
+
+	double min_x = bodies.front().x;
+	double min_y = bodies.front().y;
+	double max_x = min_x;
+	double max_y = min_y;
+	for (const auto& b : bodies)
+	{
+		min_x = std::min(min_x, b.x);
+		min_y = std::min(min_y, b.y);
+		max_x = std::max(max_x, b.x);
+		max_y = std::max(max_y, b.y);
+	}
+
+	// Square root cell, padded slightly so bodies on the upper edge fall inside
+	const double size = std::max(max_x - min_x, max_y - min_y) * 1.0001 + 1e-3;
+
+	nodes.emplace_back();
+	buildNode(0, 0, static_cast<int>(bodies.size()), min_x, min_y, size, 0);
+}
+
+void BarnesHutTree::buildNode(int node_index, int begin, int end, double min_x, double min_y, double size, int depth)
+{
+	{
+		Node& node = nodes[node_index];
+		node.min_x = min_x;
+		node.min_y = min_y;
+		node.max_x = min_x + size;
+		node.max_y = min_y + size;
+		node.size = size;
+		node.cell_size = size;
+		node.begin = begin;
+		node.end = end;
+		node.first_child = -1;
+		node.child_count = 0;
+	}
+
+	if (end - begin > LEAF_SIZE && depth < MAX_DEPTH)
+	{
+		const double half = size * 0.5;
+		const double mid_x = min_x + half;
+		const double mid_y = min_y + half;
+
+		// Partition into quadrants: [bottom-left, bottom-right, top-left, top-right]
+		const auto first = bodies.begin() + begin;
+		const auto last = bodies.begin() + end;
+		const auto split_y = std::partition(first, last, [mid_y](const Body& b) { return b.y < mid_y; });
+		const auto split_bottom = std::partition(first, split_y, [mid_x](const Body& b) { return b.x < mid_x; });
+		const auto split_top = std::partition(split_y, last, [mid_x](const Body& b) { return b.x < mid_x; });
+
+		const int bounds[5] = {
+			begin,
+			static_cast<int>(split_bottom - bodies.begin()),
+			static_cast<int>(split_y - bodies.begin()),
+			static_cast<int>(split_top - bodies.begin()),
+			end
+		};
+		const double origin_x[4] = { min_x, mid_x, min_x, mid_x };
+		const double origin_y[4] = { min_y, min_y, mid_y, mid_y };
+
+		int child_count = 0;
+		for (int q = 0; q < 4; ++q)
+			if (bounds[q + 1] > bounds[q]) ++child_count;
+
+		// Children are stored contiguously; indices are used since the node array may grow
+		const int first_child = static_cast<int>(nodes.size());
+		nodes.resize(nodes.size() + child_count);
+		nodes[node_index].first_child = first_child;
+		nodes[node_index].child_count = child_count;
+
+		int c = first_child;
+		for (int q = 0; q < 4; ++q)
+		{
+			if (bounds[q + 1] > bounds[q])
+				buildNode(c++, bounds[q], bounds[q + 1], origin_x[q], origin_y[q], half, depth + 1);
+		}
+	}
+
+	// Aggregate moments directly from the body range, which is contiguous for every node
+	double g_mass = 0.0, com_x = 0.0, com_y = 0.0;
+	double max_reach = 0.0;
+	int dominant = begin;
+	for (int k = begin; k < end; ++k)
+	{
+		const Body& b = bodies[k];
+		g_mass += b.g_mass;
+		com_x += b.g_mass * b.x;
+		com_y += b.g_mass * b.y;
+		max_reach = std::max(max_reach, b.reach);
+		if (b.g_mass > bodies[dominant].g_mass)
+			dominant = k;
+	}
+
+	Node& node = nodes[node_index];
+	const double centre_x = min_x + size * 0.5;
+	const double centre_y = min_y + size * 0.5;
+	node.g_mass = g_mass;
+	node.com_x = g_mass > 0.0 ? com_x / g_mass : centre_x;
+	node.com_y = g_mass > 0.0 ? com_y / g_mass : centre_y;
+	node.max_reach = max_reach;
+	node.dominant = dominant;
+}
+
+void BarnesHutTree::refit(const double* x, const double* y)
+{
+	for (auto& b : bodies)
+	{
+		b.x = x[b.index];
+		b.y = y[b.index];
+	}
+
+	// Children are stored after their parent, so a backward sweep finishes them first
+	for (int n = static_cast<int>(nodes.size()) - 1; n >= 0; --n)
+	{
+		Node& node = nodes[n];
+		double min_x = std::numeric_limits<double>::max(), min_y = min_x;
+		double max_x = std::numeric_limits<double>::lowest(), max_y = max_x;
+		double com_x = 0.0, com_y = 0.0;
+
+		if (node.first_child < 0)
+		{
+			for (int k = node.begin; k < node.end; ++k)
+			{
+				const Body& b = bodies[k];
+				min_x = std::min(min_x, b.x);
+				min_y = std::min(min_y, b.y);
+				max_x = std::max(max_x, b.x);
+				max_y = std::max(max_y, b.y);
+				com_x += b.g_mass * b.x;
+				com_y += b.g_mass * b.y;
+			}
+		}
+		else
+		{
+			for (int c = node.first_child; c < node.first_child + node.child_count; ++c)
+			{
+				const Node& child = nodes[c];
+				min_x = std::min(min_x, child.min_x);
+				min_y = std::min(min_y, child.min_y);
+				max_x = std::max(max_x, child.max_x);
+				max_y = std::max(max_y, child.max_y);
+				com_x += child.g_mass * child.com_x;
+				com_y += child.g_mass * child.com_y;
+			}
+		}
+
+		// Boxes now bound the bodies rather than tile the plane, and may overlap their siblings. Nodes open
+		// no later than they did when built, so a refit is at least as accurate as the build.
+		node.min_x = min_x;
+		node.min_y = min_y;
+		node.max_x = max_x;
+		node.max_y = max_y;
+		node.size = std::max({ max_x - min_x, max_y - min_y, node.cell_size });
+		node.com_x = node.g_mass > 0.0 ? com_x / node.g_mass : 0.5 * (min_x + max_x);
+		node.com_y = node.g_mass > 0.0 ? com_y / node.g_mass : 0.5 * (min_y + max_y);
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "tree_body.h"
+
+/*
+ * Quadtree over the live bodies of a single tick (Barnes-Hut).
+ *
+ * Distant nodes are approximated by their monopole. Nodes that could
+ * hold a collision or Roche partner of the query body are always opened, so those checks stay
+ * exact: every body within reach is handed to the caller as a near-field pair.
+ */
+class BarnesHutTree
+{
+public:
+	using Body = TreeBody;
+
+	/*
+	 * Rebuilds the tree. Storage is kept between calls, so a steady-state rebuild does not allocate.
+	 */
+	void build(const std::vector<Body>& source);
+
+	/*
+	 * Moves the bodies to x[index], y[index] and updates the node boxes and centres of mass in place,
+	 * keeping the partition. The tree stays exact but loosens as bodies drift from their cells, so this
+	 * is for the small moves between rebuilds, such as the substeps of a tick.
+	 */
+	void refit(const double* x, const double* y);
+
+	/*
+	 * Accumulates the far field at (x, y) into `far` and calls near(const Body&) for every body
+	 * in an opened leaf, including the query body itself. The walk stops early if near() returns false.
+	 */
+	template <typename NearFn>
+	void walk(double x, double y, double reach, double theta, FarField& far, NearFn&& near) const;
+
+	[[nodiscard]] bool empty() const noexcept { return nodes.empty(); }
+
+private:
+	static constexpr int LEAF_SIZE = 8;
+	static constexpr int MAX_DEPTH = 40;
+
+	struct Node
+	{
+		double min_x, min_y, max_x, max_y;
+		double size;		// opening size: the longest side of the box, at least the cell it was built for
+		double cell_size;
+		double com_x, com_y, g_mass;
+		double max_reach;
+		int dominant;		// position in `bodies` of the heaviest body under this node
+		int first_child;	// -1 for leaves
+		int child_count;
+		int begin, end;		// range in `bodies`
+	};
+
+	std::vector<Body> bodies;
+	std::vector<Node> nodes;
+
+	void buildNode(int node_index, int begin, int end, double min_x, double min_y, double size, int depth);
+};
+
+template <typename NearFn>
+void BarnesHutTree::walk(double x, double y, double reach, double theta, FarField& far, NearFn&& near) const
+{
+	if (nodes.empty())
+		return;
+
+	const double theta_sq = theta * theta;
+
+	int stack[4 * MAX_DEPTH + 4];
+	int top = 0;
+	stack[top++] = 0;
+
+	while (top > 0)
+	{
+		const Node& node = nodes[stack[--top]];
+
+		// Distance from the query point to the node box, used to decide if the node may hold a contact
+		const double ex = std::max({ node.min_x - x, 0.0, x - node.max_x });
+		const double ey = std::max({ node.min_y - y, 0.0, y - node.max_y });
+		const double contact_range = reach + node.max_reach;
+		const bool may_touch = ex * ex + ey * ey <= contact_range * contact_range;
+
+		const double dx = node.com_x - x;
+		const double dy = node.com_y - y;
+		const double d2 = dx * dx + dy * dy;
+
+		if (!may_touch && node.size * node.size < theta_sq * d2)
+		{
+			const double dist2 = std::max(d2, 0.01);
+			const double dist = std::sqrt(dist2);
+			const double factor = node.g_mass / (dist2 * dist);
+			far.ax += factor * dx;
+			far.ay += factor * dy;
+
+			// The heaviest body of the node is the only one that can be the strongest attractor
+			// unless the node is opened, so it is evaluated exactly.
+			const Body& dom = bodies[node.dominant];
+			const double ddx = dom.x - x;
+			const double ddy = dom.y - y;
+			const double force = dom.g_mass / std::max(ddx * ddx + ddy * ddy, 0.01);
+			if (force > far.max_force)
+			{
+				far.max_force = force;
+				far.max_index = dom.index;
+			}
+			continue;
+		}
+
+		if (node.first_child < 0)
+		{
+			for (int k = node.begin; k < node.end; ++k)
+			{
+				if (!near(bodies[k]))
+					return;
+			}
+			continue;
+		}
+
+		for (int c = node.child_count - 1; c >= 0; --c)
+			stack[top++] = node.first_child + c;
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+/*
+ * Power-of-two time rungs for the block kick-drift-kick scheme in Space::update().
+ *
+ * A body on rung r steps with timestep / 2^r. The tick is cut into 2^top_rung substeps and a body is
+ * kicked and has its forces evaluated only at the ends of its own steps, while every body drifts each
+ * substep so the active ones see current positions. All rungs meet again at the end of the tick.
+ */
+namespace BlockTimesteps
+{
+	/*
+	 * Rung for a body from its latest force evaluation. The step has to resolve the time over which
+	 * its acceleration turns (|a| / |jerk|, with the jerk taken from the change since the previous
+	 * evaluation), the orbital time around its strongest attractor and the time to cross the distance
+	 * to it at the relative speed. `strongest_force` is g_mass_j / d^2.
+	 */
+	inline int rungFor(double timestep, double eta, int max_rung, double accel, double jerk,
+		double strongest_force, double attractor_g_mass, double relative_speed)
+	{
+		if (max_rung <= 0)
+			return 0;
+
+		double dynamical_time = std::numeric_limits<double>::infinity();
+		if (jerk > 0.0)
+			dynamical_time = accel / jerk;
+		if (strongest_force > 0.0 && attractor_g_mass > 0.0)
+		{
+			const double dist = std::sqrt(attractor_g_mass / strongest_force);
+			dynamical_time = std::min(dynamical_time, std::sqrt(dist / strongest_force));
+			if (relative_speed > 0.0)
+				dynamical_time = std::min(dynamical_time, dist / relative_speed);
+		}
+
+		const double wanted = eta * dynamical_time;
+		if (wanted >= timestep)
+			return 0;
+		if (!(wanted > 0.0))
+			return max_rung;
+
+		const int rung = static_cast<int>(std::ceil(std::log2(timestep / wanted)));
+		return std::clamp(rung, 0, max_rung);
+	}
+
+	/*
+	 * Coarsest allowed rung at or above `wanted` for a body whose step ends after substep `sub`:
+	 * a body may only move to a coarser rung where a step of that rung also ends.
+	 */
+	inline int alignedRung(int wanted, int current, int top_rung, int sub)
+	{
+		int rung = std::min(wanted, top_rung);
+		while (rung < current && (sub + 1) % (1 << (top_rung - rung)) != 0)
+			++rung;
+		return rung;
+	}
+}
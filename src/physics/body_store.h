@@ -0,0 +1,126 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "../CONSTANTS.h"
+
+/*
+ * Structure-of-arrays store of the live bodies, the owner of their integrated state between ticks.
+ *
+ * Positions, velocities, accelerations, jerks and rungs are kept here in double from one tick to the
+ * next; the planets only hold a float copy for drawing. The per-tick constants (mass, radius, heat, type,
+ * family) are refreshed from the planets each tick. Bodies marked for removal are compacted out when the
+ * slots are laid out again, so the kernels never test for them. `planet` maps each slot back to its index
+ * in Space::planets for the current tick.
+ *
+ * Slots [0, sources()) are the active bodies, which source gravity. The slots after them hold passive
+ * bodies, which feel the pull of the active ones but pull on nothing, so force passes only sum over the
+ * active slots. Every pushed body is active until the caller sets the split.
+ */
+struct BodyStore
+{
+	// Integrated state
+	std::vector<double> x, y;
+	std::vector<double> vx, vy;
+	std::vector<double> ax, ay;
+	std::vector<double> jx, jy;			// time derivative of the acceleration, only kept by the Hermite integrator
+	std::vector<double> step_ax, step_ay;	// acceleration at the start of the current step
+	std::vector<double> step_x, step_y, step_vx, step_vy, step_jx, step_jy;	// rest of the state at the start of the tick
+	std::vector<int> rung;			// block timestep rung, the body steps with timestep / 2^rung, -1 if not assigned yet
+
+	// Per-tick constants
+	std::vector<double> mass;
+	std::vector<double> g_mass;
+	std::vector<double> radius;
+	std::vector<double> reach;		// furthest distance at which the body can collide or trigger a Roche breakup, widened by its swept path
+	std::vector<double> heat;		// thermal output, 0 for bodies that do not emit
+	std::vector<BodyType> type;
+	std::vector<int> id;
+	std::vector<int> planet;
+	std::vector<int> family;		// fragment family, bodies of the same one ignore each other, -1 if in none
+
+	// Results of the force pass
+	std::vector<double> strongest_force;
+	std::vector<int> strongest_slot;
+	std::vector<double> heat_in;
+	std::vector<char> has_event;	// a collision or Roche breakup was already recorded this tick
+
+	int n_sources{ 0 };		// active bodies are slots [0, n_sources)
+
+	[[nodiscard]] int size() const noexcept { return static_cast<int>(id.size()); }
+	[[nodiscard]] bool empty() const noexcept { return id.empty(); }
+	[[nodiscard]] int sources() const noexcept { return n_sources; }
+	[[nodiscard]] bool isSource(int k) const noexcept { return k < n_sources; }
+
+	void clear()
+	{
+		x.clear(); y.clear();
+		vx.clear(); vy.clear();
+		ax.clear(); ay.clear();
+		jx.clear(); jy.clear();
+		step_ax.clear(); step_ay.clear();
+		step_x.clear(); step_y.clear(); step_vx.clear(); step_vy.clear(); step_jx.clear(); step_jy.clear();
+		rung.clear();
+		mass.clear(); g_mass.clear(); radius.clear(); reach.clear(); heat.clear();
+		type.clear(); id.clear(); planet.clear(); family.clear();
+		strongest_force.clear(); strongest_slot.clear(); heat_in.clear(); has_event.clear();
+		n_sources = 0;
+	}
+
+	void push(double px, double py, double pvx, double pvy, double pax, double pay,
+		double m, double r, double reach_dist, double thermal_output, BodyType t, int body_id, int planet_index, int time_rung = 0,
+		double pjx = 0.0, double pjy = 0.0, int family_id = -1)
+	{
+		x.push_back(px); y.push_back(py);
+		vx.push_back(pvx); vy.push_back(pvy);
+		ax.push_back(pax); ay.push_back(pay);
+		jx.push_back(pjx); jy.push_back(pjy);
+		step_ax.push_back(pax); step_ay.push_back(pay);
+		step_x.push_back(px); step_y.push_back(py);
+		step_vx.push_back(pvx); step_vy.push_back(pvy);
+		step_jx.push_back(pjx); step_jy.push_back(pjy);
+		rung.push_back(time_rung);
+		mass.push_back(m);
+		g_mass.push_back(G * m);
+		radius.push_back(r);
+		reach.push_back(reach_dist);
+		heat.push_back(thermal_output);
+		type.push_back(t);
+		id.push_back(body_id);
+		planet.push_back(planet_index);
+		family.push_back(family_id);
+		strongest_force.push_back(0.0);
+		strongest_slot.push_back(-1);
+		heat_in.push_back(0.0);
+		has_event.push_back(0);
+		n_sources = size();
+	}
+
+	/*
+	 * Appends slot k of `other` with its integrated state, when the slots are laid out again. The body's
+	 * planet may have moved since, so its index is passed in.
+	 */
+	void pushFrom(const BodyStore& other, int k, int planet_index)
+	{
+		push(other.x[k], other.y[k], other.vx[k], other.vy[k], other.ax[k], other.ay[k],
+			other.mass[k], other.radius[k], other.reach[k], other.heat[k], other.type[k], other.id[k], planet_index,
+			other.rung[k], other.jx[k], other.jy[k], other.family[k]);
+	}
+
+	/*
+	 * Takes the current state as the state at the start of the tick and clears the results of the last one
+	 */
+	void startTick()
+	{
+		step_x.assign(x.begin(), x.end()); step_y.assign(y.begin(), y.end());
+		step_vx.assign(vx.begin(), vx.end()); step_vy.assign(vy.begin(), vy.end());
+		step_ax.assign(ax.begin(), ax.end()); step_ay.assign(ay.begin(), ay.end());
+		step_jx.assign(jx.begin(), jx.end()); step_jy.assign(jy.begin(), jy.end());
+		std::fill(strongest_force.begin(), strongest_force.end(), 0.0);
+		std::fill(strongest_slot.begin(), strongest_slot.end(), -1);
+		std::fill(heat_in.begin(), heat_in.end(), 0.0);
+		std::fill(has_event.begin(), has_event.end(), 0);
+	}
+};
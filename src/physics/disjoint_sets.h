@@ -0,0 +1,51 @@
+#pragma once
+
+#include <numeric>
+#include <utility>
+#include <vector>
+
+/*
+ * Union-find over the indices [0, n), with union by size and path halving, so any sequence of
+ * unite() and find() calls costs near-constant time per call. Storage is kept between uses.
+ */
+class DisjointSets
+{
+public:
+	void reset(int n)
+	{
+		parent.resize(n);
+		std::iota(parent.begin(), parent.end(), 0);
+		set_size.assign(n, 1);
+	}
+
+	[[nodiscard]] int find(int k)
+	{
+		while (parent[k] != k)
+		{
+			parent[k] = parent[parent[k]];
+			k = parent[k];
+		}
+		return k;
+	}
+
+	// Merges the sets of a and b, returns the root of the merged set
+	int unite(int a, int b)
+	{
+		a = find(a);
+		b = find(b);
+		if (a == b)
+			return a;
+		if (set_size[a] < set_size[b])
+			std::swap(a, b);
+		parent[b] = a;
+		set_size[a] += set_size[b];
+		return a;
+	}
+
+	// Number of indices in the set of k
+	[[nodiscard]] int size(int k) { return set_size[find(k)]; }
+
+private:
+	std::vector<int> parent;
+	std::vector<int> set_size;
+};
@@ -0,0 +1,143 @@
+#include "encounter_subcycling.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Orbital time scale of a pair, the time to turn by one radian on a circular orbit
+double pairTime(const BodyStore& s, int i, int j)
+{
+	const double dx = s.x[j] - s.x[i];
+	const double dy = s.y[j] - s.y[i];
+	const double dist2 = std::max(dx * dx + dy * dy, 0.01);
+	return std::sqrt(dist2 * std::sqrt(dist2) / (s.g_mass[i] + s.g_mass[j]));
+}
+
+}
+
+namespace EncounterSubcycling
+{
+	void findGroups(const BodyStore& store, double timestep, const std::vector<char>& excluded,
+		std::vector<std::vector<int>>& groups, DisjointSets& sets, std::pmr::memory_resource* scratch)
+	{
+		const int n = store.size();
+
+		sets.reset(n);
+		bool any = false;
+		for (int i = 0; i < n; ++i)
+		{
+			const int j = store.strongest_slot[i];
+			if (j < 0 || j == i || excluded[i] || excluded[j]) continue;
+			if (store.g_mass[i] + store.g_mass[j] <= 0.0 || timestep <= ETA * pairTime(store, i, j)) continue;
+
+			sets.unite(i, j);
+			any = true;
+		}
+		if (!any)
+		{
+			groups.clear();
+			return;
+		}
+
+		// Lists of the last call are refilled, so their storage survives while the group count holds.
+		// Bodies without a close pair are sets of one and stay out.
+		std::pmr::vector<int> group_of(n, -1, scratch);
+		size_t used = 0;
+		for (int k = 0; k < n; ++k)
+		{
+			const int root = sets.find(k);
+			if (sets.size(root) < 2) continue;
+			if (group_of[root] < 0)
+			{
+				group_of[root] = static_cast<int>(used);
+				if (used == groups.size())
+					groups.emplace_back();
+				else
+					groups[used].clear();
+				++used;
+			}
+			groups[group_of[root]].push_back(k);
+		}
+		groups.resize(used);
+	}
+
+	void groupAcceleration(const BodyStore& store, const std::vector<int>& group, double* ax, double* ay)
+	{
+		const int n = static_cast<int>(group.size());
+		std::fill(ax, ax + n, 0.0);
+		std::fill(ay, ay + n, 0.0);
+
+		for (int a = 0; a < n; ++a)
+		{
+			const int i = group[a];
+			for (int b = a + 1; b < n; ++b)
+			{
+				const int j = group[b];
+				const double dx = store.x[j] - store.x[i];
+				const double dy = store.y[j] - store.y[i];
+				const double dist2 = std::max(dx * dx + dy * dy, 0.01);
+				const double inv_d3 = 1.0 / (dist2 * std::sqrt(dist2));
+
+				// Passive bodies feel the pair but do not pull back, as in the force pass
+				const double g_mass_i = store.isSource(i) ? store.g_mass[i] : 0.0;
+				const double g_mass_j = store.isSource(j) ? store.g_mass[j] : 0.0;
+				ax[a] += g_mass_j * inv_d3 * dx;
+				ay[a] += g_mass_j * inv_d3 * dy;
+				ax[b] -= g_mass_i * inv_d3 * dx;
+				ay[b] -= g_mass_i * inv_d3 * dy;
+			}
+		}
+	}
+
+	int advance(BodyStore& store, const std::vector<int>& group, double dt)
+	{
+		const int n = static_cast<int>(group.size());
+
+		double shortest = std::numeric_limits<double>::infinity();
+		for (int a = 0; a < n; ++a)
+			for (int b = a + 1; b < n; ++b)
+				if (store.g_mass[group[a]] + store.g_mass[group[b]] > 0.0)
+					shortest = std::min(shortest, pairTime(store, group[a], group[b]));
+		const int substeps = std::clamp(static_cast<int>(std::ceil(std::abs(dt) / (ETA * shortest))), 1, MAX_SUBSTEPS);
+		const double h = dt / substeps;
+
+		// Yoshida's fourth-order composition of three leapfrog steps, see Integrator::YOSHIDA4
+		const double cbrt2 = std::cbrt(2.0);
+		const double w1 = 1.0 / (2.0 - cbrt2);
+		const double w0 = -cbrt2 * w1;
+		const double drifts[3] = { w1, w0, w1 };
+		const double kicks[4] = { 0.5 * w1, 0.5 * (w1 + w0), 0.5 * (w0 + w1), 0.5 * w1 };
+
+		std::vector<double> ax(n), ay(n);
+		groupAcceleration(store, group, ax.data(), ay.data());
+
+		const auto kick = [&](double step) {
+			for (int a = 0; a < n; ++a)
+			{
+				store.vx[group[a]] += ax[a] * step;
+				store.vy[group[a]] += ay[a] * step;
+			}
+		};
+		const auto drift = [&](double step) {
+			for (int a = 0; a < n; ++a)
+			{
+				store.x[group[a]] += store.vx[group[a]] * step;
+				store.y[group[a]] += store.vy[group[a]] * step;
+			}
+		};
+
+		for (int sub = 0; sub < substeps; ++sub)
+		{
+			kick(kicks[0] * h);
+			for (int stage = 0; stage < 3; ++stage)
+			{
+				drift(drifts[stage] * h);
+				groupAcceleration(store, group, ax.data(), ay.data());
+				kick(kicks[stage + 1] * h);
+			}
+		}
+		return substeps;
+	}
+}
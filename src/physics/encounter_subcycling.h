@@ -0,0 +1,43 @@
+#pragma once
+
+#include <memory_resource>
+#include <vector>
+
+#include "body_store.h"
+#include "disjoint_sets.h"
+
+/*
+ * Close-encounter subcycling for the leapfrog tick in Space::update(), after the hybrid scheme of Mercury.
+ *
+ * A body and its strongest attractor form a close pair when the tick is long compared with their
+ * mutual orbital time, sqrt(d^3 / (G (m_i + m_j))). Close pairs are joined into groups (a binary, a
+ * planet with its moons). The leapfrog only kicks group members with the pull of bodies outside their
+ * group. Their mutual pull and their motion are integrated separately over the tick, with as many
+ * fourth-order Yoshida substeps as the closest pair needs. Every other body keeps the single large step.
+ */
+namespace EncounterSubcycling
+{
+	// Substep as a fraction of the closest pair's orbital time scale, also the threshold for a close pair
+	inline constexpr double ETA = 0.1;
+	inline constexpr int MAX_SUBSTEPS = 1024;
+
+	/*
+	 * Groups of slots linked by close pairs, from each body's strongest attractor in `store.strongest_slot`.
+	 * Slots with `excluded[k]` set are never grouped. Bodies without a close pair are left out.
+	 * Pairs are joined in `sets`, the other working arrays come from `scratch`, and the member lists keep
+	 * their storage from call to call.
+	 */
+	void findGroups(const BodyStore& store, double timestep, const std::vector<char>& excluded,
+		std::vector<std::vector<int>>& groups, DisjointSets& sets, std::pmr::memory_resource* scratch);
+
+	/*
+	 * Pull of the group's members on each other, with the force pass' softening.
+	 * Fills ax / ay[0 .. group.size()).
+	 */
+	void groupAcceleration(const BodyStore& store, const std::vector<int>& group, double* ax, double* ay);
+
+	/*
+	 * Moves the group's members through `dt` under their mutual pull alone. Returns the number of substeps.
+	 */
+	int advance(BodyStore& store, const std::vector<int>& group, double dt);
+}
@@ -0,0 +1,389 @@
+#include "fmm.h"
+
+#include "../task_pool.h"
+
+void FmmSolver::build(const std::vector<Body>& source, int expansion_order, double theta)
+{
+	order = std::clamp(expansion_order, 0, MAX_ORDER);
+	n_terms = (order + 1) * (order + 2) / 2;
+
+	bodies.assign(source.begin(), source.end());
+	nodes.clear();
+
+	if (bodies.empty())
+		return;
+
+	double min_x = bodies.front().x;
+	double min_y = bodies.front().y;
+	double max_x = min_x;
+	double max_y = min_y;
+	int max_index = 0;
+	for (const auto& b : bodies)
+	{
+		min_x = std::min(min_x, b.x);
+		min_y = std::min(min_y, b.y);
+		max_x = std::max(max_x, b.x);
+		max_y = std::max(max_y, b.y);
+		max_index = std::max(max_index, b.index);
+	}
+
+	const double size = std::max(max_x - min_x, max_y - min_y) * 1.0001 + 1e-3;
+
+	leaf_of_slot.assign(bodies.size(), -1);
+	nodes.emplace_back();
+	buildNode(0, 0, static_cast<int>(bodies.size()), min_x, min_y, size, 0);
+
+	slot_of_index.assign(static_cast<size_t>(max_index) + 1, -1);
+	for (size_t k = 0; k < bodies.size(); ++k)
+		slot_of_index[bodies[k].index] = static_cast<int>(k);
+
+	upwardPass();
+	traverse(theta);
+	translateMultipoles();
+	downwardPass();
+}
+
+void FmmSolver::buildNode(int node_index, int begin, int end, double min_x, double min_y, double size, int depth)
+{
+	{
+		Node& node = nodes[node_index];
+		node.min_x = min_x;
+		node.min_y = min_y;
+		node.size = size;
+		node.cx = min_x + size * 0.5;
+		node.cy = min_y + size * 0.5;
+		node.begin = begin;
+		node.end = end;
+		node.first_child = -1;
+		node.child_count = 0;
+	}
+
+	if (end - begin > LEAF_SIZE && depth < MAX_DEPTH)
+	{
+		const double half = size * 0.5;
+		const double mid_x = min_x + half;
+		const double mid_y = min_y + half;
+
+		const auto first = bodies.begin() + begin;
+		const auto last = bodies.begin() + end;
+		const auto split_y = std::partition(first, last, [mid_y](const Body& b) { return b.y < mid_y; });
+		const auto split_bottom = std::partition(first, split_y, [mid_x](const Body& b) { return b.x < mid_x; });
+		const auto split_top = std::partition(split_y, last, [mid_x](const Body& b) { return b.x < mid_x; });
+
+		const int bounds[5] = {
+			begin,
+			static_cast<int>(split_bottom - bodies.begin()),
+			static_cast<int>(split_y - bodies.begin()),
+			static_cast<int>(split_top - bodies.begin()),
+			end
+		};
+		const double origin_x[4] = { min_x, mid_x, min_x, mid_x };
+		const double origin_y[4] = { min_y, min_y, mid_y, mid_y };
+
+		int child_count = 0;
+		for (int q = 0; q < 4; ++q)
+			if (bounds[q + 1] > bounds[q]) ++child_count;
+
+		const int first_child = static_cast<int>(nodes.size());
+		nodes.resize(nodes.size() + child_count);
+		nodes[node_index].first_child = first_child;
+		nodes[node_index].child_count = child_count;
+
+		int c = first_child;
+		for (int q = 0; q < 4; ++q)
+		{
+			if (bounds[q + 1] > bounds[q])
+				buildNode(c++, bounds[q], bounds[q + 1], origin_x[q], origin_y[q], half, depth + 1);
+		}
+	}
+
+	Node& node = nodes[node_index];
+	double radius_sq = 0.0;
+	double max_reach = 0.0;
+	int dominant = begin;
+	for (int k = begin; k < end; ++k)
+	{
+		const Body& b = bodies[k];
+		const double dx = b.x - node.cx;
+		const double dy = b.y - node.cy;
+		radius_sq = std::max(radius_sq, dx * dx + dy * dy);
+		max_reach = std::max(max_reach, b.reach);
+		if (b.g_mass > bodies[dominant].g_mass)
+			dominant = k;
+		if (node.first_child < 0)
+			leaf_of_slot[k] = node_index;
+	}
+	node.radius = std::sqrt(radius_sq);
+	node.max_reach = max_reach;
+	node.dominant = dominant;
+}
+
+void FmmSolver::scaledPowers(double x, double* out) const
+{
+	// out[k] = x^k / k!
+	out[0] = 1.0;
+	for (int k = 1; k <= order; ++k)
+		out[k] = out[k - 1] * x / k;
+}
+
+void FmmSolver::derivatives(double x, double y, double* D) const
+{
+	// Partial derivatives of 1/r at (x, y), from the recurrence
+	// n r^2 D(a,b) = -(2n-1) (a x D(a-1,b) + b y D(a,b-1)) - (n-1) (a(a-1) D(a-2,b) + b(b-1) D(a,b-2))
+	const double r2 = x * x + y * y;
+	const double inv_r2 = 1.0 / r2;
+	D[0] = std::sqrt(inv_r2);
+
+	for (int n = 1; n <= order; ++n)
+	{
+		const double scale = inv_r2 / n;
+		for (int b = 0; b <= n; ++b)
+		{
+			const int a = n - b;
+			double sum = 0.0;
+			if (a >= 1) sum -= (2 * n - 1) * a * x * D[term(a - 1, b)];
+			if (b >= 1) sum -= (2 * n - 1) * b * y * D[term(a, b - 1)];
+			if (a >= 2) sum -= (n - 1) * a * (a - 1) * D[term(a - 2, b)];
+			if (b >= 2) sum -= (n - 1) * b * (b - 1) * D[term(a, b - 2)];
+			D[term(a, b)] = sum * scale;
+		}
+	}
+}
+
+double FmmSolver::attractorForce(int slot, double x, double y) const
+{
+	const Body& b = bodies[slot];
+	const double dx = b.x - x;
+	const double dy = b.y - y;
+	return b.g_mass / std::max(dx * dx + dy * dy, 0.01);
+}
+
+void FmmSolver::upwardPass()
+{
+	const size_t n_coeffs = nodes.size() * n_terms;
+	multipole_g.assign(n_coeffs, 0.0);
+
+	double px[MAX_ORDER + 1], py[MAX_ORDER + 1];
+
+	// Children are always stored after their parent, so a reverse sweep is bottom-up
+	for (int n = static_cast<int>(nodes.size()) - 1; n >= 0; --n)
+	{
+		const Node& node = nodes[n];
+		double* Mg = &multipole_g[static_cast<size_t>(n) * n_terms];
+
+		if (node.first_child < 0)
+		{
+			// Particle to multipole
+			for (int k = node.begin; k < node.end; ++k)
+			{
+				const Body& b = bodies[k];
+				scaledPowers(b.x - node.cx, px);
+				scaledPowers(b.y - node.cy, py);
+				for (int d = 0; d <= order; ++d)
+				{
+					for (int j = 0; j <= d; ++j)
+					{
+						Mg[term(d - j, j)] += b.g_mass * px[d - j] * py[j];
+					}
+				}
+			}
+			continue;
+		}
+
+		// Multipole to multipole: M(a) += sum over e <= a of Mc(e) s^(a-e) / (a-e)!
+		for (int c = node.first_child; c < node.first_child + node.child_count; ++c)
+		{
+			const Node& child = nodes[c];
+			const double* Mcg = &multipole_g[static_cast<size_t>(c) * n_terms];
+			scaledPowers(child.cx - node.cx, px);
+			scaledPowers(child.cy - node.cy, py);
+
+			for (int d = 0; d <= order; ++d)
+			{
+				for (int j = 0; j <= d; ++j)
+				{
+					const int a = d - j;
+					double sum_g = 0.0;
+					for (int ea = 0; ea <= a; ++ea)
+					{
+						for (int eb = 0; eb <= j; ++eb)
+							sum_g += Mcg[term(ea, eb)] * px[a - ea] * py[j - eb];
+					}
+					Mg[term(a, j)] += sum_g;
+				}
+			}
+		}
+	}
+}
+
+void FmmSolver::traverse(double theta)
+{
+	m2l_pairs.clear();
+	near_pairs.clear();
+	pair_stack.clear();
+	pair_stack.emplace_back(0, 0);
+
+	while (!pair_stack.empty())
+	{
+		const auto [t, s] = pair_stack.back();
+		pair_stack.pop_back();
+
+		const Node& T = nodes[t];
+		const Node& S = nodes[s];
+		const double dx = T.cx - S.cx;
+		const double dy = T.cy - S.cy;
+		const double dist = std::sqrt(dx * dx + dy * dy);
+		const double gap = dist - T.radius - S.radius;
+
+		if (t != s && T.radius + S.radius < theta * dist && gap > T.max_reach + S.max_reach)
+		{
+			m2l_pairs.emplace_back(t, s);
+			continue;
+		}
+
+		const bool t_leaf = T.first_child < 0;
+		const bool s_leaf = S.first_child < 0;
+		if (t_leaf && s_leaf)
+		{
+			near_pairs.emplace_back(t, s);
+			continue;
+		}
+
+		// Split the larger cell
+		if (t_leaf || (!s_leaf && S.radius > T.radius))
+		{
+			for (int c = S.first_child; c < S.first_child + S.child_count; ++c)
+				pair_stack.emplace_back(t, c);
+		}
+		else
+		{
+			for (int c = T.first_child; c < T.first_child + T.child_count; ++c)
+				pair_stack.emplace_back(c, s);
+		}
+	}
+
+	// Group both lists by target node (counting sort)
+	const auto group = [this](const std::vector<std::pair<int, int>>& pairs, std::vector<int>& start, std::vector<int>& sources)
+	{
+		start.assign(nodes.size() + 1, 0);
+		for (const auto& p : pairs)
+			++start[p.first + 1];
+		for (size_t n = 0; n < nodes.size(); ++n)
+			start[n + 1] += start[n];
+
+		sources.resize(pairs.size());
+		cursor.assign(start.begin(), start.end() - 1);
+		for (const auto& p : pairs)
+			sources[cursor[p.first]++] = p.second;
+	};
+	group(m2l_pairs, m2l_start, m2l_sources);
+	group(near_pairs, near_start, near_sources);
+}
+
+void FmmSolver::multipoleToLocal(const double* M, const double* D, double* L) const
+{
+	// L(b) += sum over a of (-1)^|a| M(a) D(a+b)
+	for (int nb = 0; nb <= order; ++nb)
+	{
+		for (int bb = 0; bb <= nb; ++bb)
+		{
+			const int ba = nb - bb;
+			double sum = 0.0;
+			for (int na = 0; na + nb <= order; ++na)
+			{
+				const double sign = (na & 1) ? -1.0 : 1.0;
+				double sum_n = 0.0;
+				for (int ab = 0; ab <= na; ++ab)
+					sum_n += M[term(na - ab, ab)] * D[term(na - ab + ba, ab + bb)];
+				sum += sign * sum_n;
+			}
+			L[term(ba, bb)] += sum;
+		}
+	}
+}
+
+void FmmSolver::translateMultipoles()
+{
+	const size_t n_coeffs = nodes.size() * n_terms;
+	local_g.assign(n_coeffs, 0.0);
+	attractor.assign(nodes.size(), -1);
+
+	const int n_nodes = static_cast<int>(nodes.size());
+
+	TaskPool::global().parallelChunks(0, n_nodes, 16, [&](int begin, int end) {
+		double D[MAX_TERMS];
+
+		for (int t = begin; t < end; ++t)
+		{
+			const Node& T = nodes[t];
+			double* Lg = &local_g[static_cast<size_t>(t) * n_terms];
+			double best_force = 0.0;
+
+			for (int k = m2l_start[t]; k < m2l_start[t + 1]; ++k)
+			{
+				const int s = m2l_sources[k];
+				const Node& S = nodes[s];
+				const double* Mg = &multipole_g[static_cast<size_t>(s) * n_terms];
+
+				derivatives(T.cx - S.cx, T.cy - S.cy, D);
+				multipoleToLocal(Mg, D, Lg);
+
+				const double force = attractorForce(S.dominant, T.cx, T.cy);
+				if (force > best_force)
+				{
+					best_force = force;
+					attractor[t] = S.dominant;
+				}
+			}
+		}
+	});
+}
+
+void FmmSolver::downwardPass()
+{
+	double px[MAX_ORDER + 1], py[MAX_ORDER + 1];
+
+	// Parents are always stored before their children, so a forward sweep is top-down
+	for (size_t n = 0; n < nodes.size(); ++n)
+	{
+		const Node& node = nodes[n];
+		if (node.first_child < 0)
+			continue;
+
+		const double* Lg = &local_g[n * n_terms];
+
+		for (int c = node.first_child; c < node.first_child + node.child_count; ++c)
+		{
+			const Node& child = nodes[c];
+			double* Lcg = &local_g[static_cast<size_t>(c) * n_terms];
+
+			// Local to local: Lc(b) += sum over e of L(b+e) s^e / e!
+			scaledPowers(child.cx - node.cx, px);
+			scaledPowers(child.cy - node.cy, py);
+			for (int nb = 0; nb <= order; ++nb)
+			{
+				for (int bb = 0; bb <= nb; ++bb)
+				{
+					const int ba = nb - bb;
+					double sum_g = 0.0;
+					for (int ne = 0; ne + nb <= order; ++ne)
+					{
+						for (int eb = 0; eb <= ne; ++eb)
+						{
+							const int ea = ne - eb;
+							sum_g += Lg[term(ba + ea, bb + eb)] * px[ea] * py[eb];
+						}
+					}
+					Lcg[term(ba, bb)] += sum_g;
+				}
+			}
+
+			// The parent's far attractor is also far from the child
+			if (attractor[n] >= 0 &&
+				(attractor[c] < 0 || attractorForce(attractor[n], child.cx, child.cy) > attractorForce(attractor[c], child.cx, child.cy)))
+			{
+				attractor[c] = attractor[n];
+			}
+		}
+	}
+}
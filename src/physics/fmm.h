@@ -0,0 +1,145 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+
+#include "tree_body.h"
+
+/*
+ * Fast multipole solver for the simulation's 1/r potential (1/r^2 force) in the plane.
+ *
+ * Cells carry Cartesian Taylor multipole and local expansions of 1/r up to a configurable order,
+ * with G*mass as the charge. A dual tree walk turns well separated cell pairs into multipole-to-local
+ * translations. Cell pairs that could hold a collision or Roche partner are never approximated,
+ * so the caller sees every body within reach as a near-field pair and keeps those checks exact.
+ */
+class FmmSolver
+{
+public:
+	using Body = TreeBody;
+
+	static constexpr int MAX_ORDER = 12;
+
+	/*
+	 * Builds the tree and evaluates all cell expansions. `theta` bounds (r_a + r_b) / dist for cell
+	 * pairs that are approximated. Storage is kept between calls.
+	 */
+	void build(const std::vector<Body>& source, int expansion_order, double theta);
+
+	/*
+	 * Accumulates the far field of the body with caller index `index` into `far` and calls
+	 * near(const Body&) for every body of its near-field leaves, including the body itself.
+	 * Stops early if near() returns false.
+	 */
+	template <typename NearFn>
+	void query(int index, FarField& far, NearFn&& near) const;
+
+	[[nodiscard]] bool empty() const noexcept { return nodes.empty(); }
+
+private:
+	static constexpr int LEAF_SIZE = 8;
+	static constexpr int MAX_DEPTH = 40;
+	static constexpr int MAX_TERMS = (MAX_ORDER + 1) * (MAX_ORDER + 2) / 2;
+
+	struct Node
+	{
+		double min_x, min_y, size;
+		double cx, cy;		// expansion centre, the middle of the cell
+		double radius;		// furthest body from the centre
+		double max_reach;
+		int dominant;		// position in `bodies` of the heaviest body under this node
+		int first_child;	// -1 for leaves
+		int child_count;
+		int begin, end;		// range in `bodies`
+	};
+
+	int order{ 4 };
+	int n_terms{ 15 };
+
+	std::vector<Body> bodies;
+	std::vector<Node> nodes;
+	std::vector<int> slot_of_index;
+	std::vector<int> leaf_of_slot;
+
+	// Expansion coefficients, n_terms per node
+	std::vector<double> multipole_g;
+	std::vector<double> local_g;
+
+	// Strongest far-field attractor candidate per node, as a position in `bodies`
+	std::vector<int> attractor;
+
+	// Interaction lists as (target, source) node pairs, then grouped by target node
+	std::vector<std::pair<int, int>> pair_stack;
+	std::vector<std::pair<int, int>> m2l_pairs;
+	std::vector<std::pair<int, int>> near_pairs;
+	std::vector<int> m2l_start, m2l_sources;
+	std::vector<int> near_start, near_sources;
+	std::vector<int> cursor;
+
+	// Multi-index (a, b), a + b <= order, stored by total degree
+	static constexpr int term(int a, int b) { return (a + b) * (a + b + 1) / 2 + b; }
+
+	void buildNode(int node_index, int begin, int end, double min_x, double min_y, double size, int depth);
+	void upwardPass();
+	void traverse(double theta);
+	void translateMultipoles();
+	void downwardPass();
+	void multipoleToLocal(const double* M, const double* D, double* L) const;
+	void derivatives(double x, double y, double* D) const;
+	void scaledPowers(double x, double* out) const;
+	double attractorForce(int slot, double x, double y) const;
+};
+
+template <typename NearFn>
+void FmmSolver::query(int index, FarField& far, NearFn&& near) const
+{
+	if (index < 0 || index >= static_cast<int>(slot_of_index.size()) || slot_of_index[index] < 0)
+		return;
+
+	const int slot = slot_of_index[index];
+	const int leaf = leaf_of_slot[slot];
+	const Node& node = nodes[leaf];
+	const Body& self = bodies[slot];
+
+	// Local expansion to particle, the gradient of the potential
+	double px[MAX_ORDER + 1], py[MAX_ORDER + 1];
+	scaledPowers(self.x - node.cx, px);
+	scaledPowers(self.y - node.cy, py);
+
+	const double* Lg = &local_g[static_cast<size_t>(leaf) * n_terms];
+	double gx = 0.0, gy = 0.0;
+	for (int n = 0; n < order; ++n)
+	{
+		for (int b = 0; b <= n; ++b)
+		{
+			const int a = n - b;
+			const double w = px[a] * py[b];
+			gx += Lg[term(a + 1, b)] * w;
+			gy += Lg[term(a, b + 1)] * w;
+		}
+	}
+	far.ax += gx;
+	far.ay += gy;
+
+	if (attractor[leaf] >= 0)
+	{
+		const double force = attractorForce(attractor[leaf], self.x, self.y);
+		if (force > far.max_force)
+		{
+			far.max_force = force;
+			far.max_index = bodies[attractor[leaf]].index;
+		}
+	}
+
+	for (int k = near_start[leaf]; k < near_start[leaf + 1]; ++k)
+	{
+		const Node& source = nodes[near_sources[k]];
+		for (int m = source.begin; m < source.end; ++m)
+		{
+			if (!near(bodies[m]))
+				return;
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#include "heat_emitters.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simd_lanes.h"
+#include "../task_pool.h"
+#include "../parallel_tuning.h"
+
+namespace {
+
+// Heat of one emitter on receivers [begin, end), several receivers per instruction
+void addEmitter(const HeatEmitters::Emitter& e, const double* x, const double* y, int begin, int end, double* out)
+{
+	using L = SimdLanes;
+	const L::V ex = L::set(e.x), ey = L::set(e.y), output = L::set(e.output), one = L::set(1.0);
+
+	int k = begin;
+	for (; k + L::WIDTH <= end; k += L::WIDTH)
+	{
+		const L::V dx = L::sub(L::load(x + k), ex);
+		const L::V dy = L::sub(L::load(y + k), ey);
+		const L::V dist = L::max(L::sqrt(L::fma(dx, dx, L::mul(dy, dy))), one);
+		L::store(out + k, L::add(L::load(out + k), L::div(output, dist)));
+	}
+	for (; k < end; ++k)
+	{
+		const double dx = x[k] - e.x;
+		const double dy = y[k] - e.y;
+		out[k] += e.output / std::max(std::sqrt(dx * dx + dy * dy), 1.0);
+	}
+}
+
+}
+
+double HeatEmitters::at(double x, double y) const
+{
+	double heat = 0.0;
+	for (const Emitter& e : emitters)
+		heat += e.output / std::max(std::hypot(e.x - x, e.y - y), 1.0);
+	return heat;
+}
+
+void HeatEmitters::accumulate(const double* x, const double* y, int n, double* out) const
+{
+	// Blocks of receivers stay in L1 while every emitter is applied to them
+	constexpr int BLOCK = 1024;
+	const int n_blocks = (n + BLOCK - 1) / BLOCK;
+
+	// A receiver is a row of one term per emitter, so the force schedule is scaled to the rows of a block
+	const int block_rows = std::max(static_cast<int>(BLOCK * emitters.size() / ParallelTuning::FORCE_ROW), 1);
+	const TaskPool::Schedule schedule = ParallelTuning::global().schedule(ParallelLoop::BODY_FORCE).perBlock(block_rows);
+	TaskPool::global().parallelFor(0, n_blocks, schedule, [&](int block) {
+		const int begin = block * BLOCK;
+		const int end = std::min(begin + BLOCK, n);
+		std::fill(out + begin, out + end, 0.0);
+
+		for (const Emitter& e : emitters)
+		{
+			// Split around the emitter's own slot instead of testing for it
+			if (e.slot >= begin && e.slot < end)
+			{
+				addEmitter(e, x, y, begin, e.slot, out);
+				addEmitter(e, x, y, e.slot + 1, end, out);
+			}
+			else
+			{
+				addEmitter(e, x, y, begin, end, out);
+			}
+		}
+	});
+}
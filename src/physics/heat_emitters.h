@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/*
+ * The bodies that radiate heat (stars, brown dwarfs, hot remnants), usually a handful.
+ *
+ * Heat falls off as output / max(dist, 1) and only emitters give it off, so the heat every body receives
+ * is a receivers x emitters sum instead of a term in the all-pairs force pass. Space rebuilds the list
+ * from the live bodies every tick and answers point queries (the ambient temperature of a spawned body)
+ * from it as well.
+ */
+class HeatEmitters
+{
+public:
+	struct Emitter
+	{
+		double x, y;
+		double output;	// thermal output per unit time
+		int id;			// body id
+		int slot;		// index of the emitter among the receivers of accumulate(), -1 if it is not one
+	};
+
+	void clear() { emitters.clear(); }
+	void add(double x, double y, double output, int id, int slot) { emitters.push_back({ x, y, output, id, slot }); }
+
+	[[nodiscard]] size_t size() const noexcept { return emitters.size(); }
+	[[nodiscard]] bool empty() const noexcept { return emitters.empty(); }
+	[[nodiscard]] const std::vector<Emitter>& all() const noexcept { return emitters; }
+
+	/*
+	 * Heat arriving at (x, y) from all emitters.
+	 */
+	[[nodiscard]] double at(double x, double y) const;
+
+	/*
+	 * Sets out[k] to the heat arriving at receiver k, at (x[k], y[k]), for k in [0, n). An emitter does not
+	 * heat its own slot.
+	 */
+	void accumulate(const double* x, const double* y, int n, double* out) const;
+
+private:
+	std::vector<Emitter> emitters;
+};
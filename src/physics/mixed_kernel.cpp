@@ -0,0 +1,210 @@
+#include "mixed_kernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simd_lanes.h"
+
+namespace {
+
+using L = SimdLanesF;
+
+// Contacts are only flagged here, so a little slack covers the float rounding of the separation
+constexpr float CONTACT_MARGIN = 1.01f;
+
+struct LaneSums
+{
+	L::V ax, ay, ax_comp, ay_comp;
+	L::V heat, max_force, max_slot;
+	L::M contact;
+};
+
+// Kahan summation: the low-order bits lost by each add are carried into the next one
+inline void compensatedAdd(L::V& sum, L::V& comp, L::V value)
+{
+	const L::V y = L::sub(value, comp);
+	const L::V t = L::add(sum, y);
+	comp = L::sub(L::sub(t, sum), y);
+	sum = t;
+}
+}
+
+void MixedPairKernel::prepare(const BodyStore& store)
+{
+	const int n = store.size();
+	sources = store.sources();
+	x.resize(n);
+	y.resize(n);
+	g_mass.resize(n);
+	heat.resize(n);
+	reach.resize(n);
+	if (n == 0)
+		return;
+
+	const auto [min_x, max_x] = std::minmax_element(store.x.begin(), store.x.end());
+	const auto [min_y, max_y] = std::minmax_element(store.y.begin(), store.y.end());
+	const double centre_x = 0.5 * (*min_x + *max_x);
+	const double centre_y = 0.5 * (*min_y + *max_y);
+
+	for (int k = 0; k < n; ++k)
+	{
+		x[k] = static_cast<float>(store.x[k] - centre_x);
+		y[k] = static_cast<float>(store.y[k] - centre_y);
+		g_mass[k] = static_cast<float>(store.g_mass[k]);
+		heat[k] = static_cast<float>(store.heat[k]);
+		reach[k] = static_cast<float>(store.reach[k]) * CONTACT_MARGIN;
+	}
+}
+
+template <bool Gravity, bool Heat, typename TargetOf>
+void MixedPairKernel::accumulateTargets(int n_targets, TargetOf target_of, PairKernel::Sums* out) const
+{
+	const int n = sources;
+	for (int t = 0; t < n_targets; ++t)
+		out[t] = PairKernel::Sums{};
+
+	const float* px = x.data();
+	const float* py = y.data();
+	const float* pg = g_mass.data();
+	const float* ph = heat.data();
+	const float* pr = reach.data();
+
+	const L::V min_d2 = L::set(0.01f);
+	const L::V one = L::set(1.0f);
+	const L::V half = L::set(0.5f);
+	const L::V three_halves = L::set(1.5f);
+
+	for (int tile = 0; tile < n; tile += PairKernel::TILE)
+	{
+		const int tile_end = std::min(tile + PairKernel::TILE, n);
+
+		for (int t = 0; t < n_targets; ++t)
+		{
+			const int i = target_of(t);
+			PairKernel::Sums& sums = out[t];
+			const float xi = px[i], yi = py[i], reach_i = pr[i];
+			const L::V vxi = L::set(xi), vyi = L::set(yi), vreach_i = L::set(reach_i);
+			LaneSums acc{ L::set(0.0f), L::set(0.0f), L::set(0.0f), L::set(0.0f),
+				L::set(0.0f), L::set(0.0f), L::set(-1.0f), L::none() };
+
+			const auto lanes = [&](int j_begin, int j_end) {
+				int j = j_begin;
+				for (; j + L::WIDTH <= j_end; j += L::WIDTH)
+				{
+					const L::V dx = L::sub(L::load(px + j), vxi);
+					const L::V dy = L::sub(L::load(py + j), vyi);
+					const L::V d2 = L::max(L::fma(dx, dx, L::mul(dy, dy)), min_d2);
+
+					if constexpr (Gravity || Heat)
+					{
+						// rsqrt estimate plus one Newton step: y' = y * (1.5 - 0.5 * d2 * y^2)
+						L::V inv_d = L::rsqrt(d2);
+						inv_d = L::mul(inv_d, L::sub(three_halves, L::mul(L::mul(half, d2), L::mul(inv_d, inv_d))));
+
+						if constexpr (Gravity)
+						{
+							const L::V force = L::mul(L::load(pg + j), L::mul(inv_d, inv_d));
+							const L::V factor = L::mul(force, inv_d);
+							compensatedAdd(acc.ax, acc.ax_comp, L::mul(factor, dx));
+							compensatedAdd(acc.ay, acc.ay_comp, L::mul(factor, dy));
+
+							const L::M stronger = L::greater(force, acc.max_force);
+							acc.max_force = L::select(stronger, force, acc.max_force);
+							acc.max_slot = L::select(stronger, L::iota(static_cast<float>(j)), acc.max_slot);
+						}
+						if constexpr (Heat)
+							acc.heat = L::fma(L::load(ph + j), L::min(inv_d, one), acc.heat);
+					}
+
+					const L::V contact_range = L::add(vreach_i, L::load(pr + j));
+					acc.contact = L::either(acc.contact, L::less(d2, L::mul(contact_range, contact_range)));
+				}
+
+				// Remainder, summed straight into the double totals
+				for (; j < j_end; ++j)
+				{
+					const float dx = px[j] - xi;
+					const float dy = py[j] - yi;
+					const float d2 = std::max(dx * dx + dy * dy, 0.01f);
+					if constexpr (Gravity || Heat)
+					{
+						const float inv_d = 1.0f / std::sqrt(d2);
+						if constexpr (Gravity)
+						{
+							const float force = pg[j] * inv_d * inv_d;
+							sums.ax += static_cast<double>(force * inv_d * dx);
+							sums.ay += static_cast<double>(force * inv_d * dy);
+							if (force > sums.max_force || (force == sums.max_force && sums.max_slot > j))
+							{
+								sums.max_force = force;
+								sums.max_slot = j;
+							}
+						}
+						if constexpr (Heat)
+							sums.heat += ph[j] * std::min(inv_d, 1.0f);
+					}
+					const float contact_range = reach_i + pr[j];
+					sums.contact = sums.contact || d2 < contact_range * contact_range;
+				}
+			};
+
+			// Split the tile around i instead of testing for the self pair
+			if (i >= tile && i < tile_end)
+			{
+				lanes(tile, i);
+				lanes(i + 1, tile_end);
+			}
+			else
+			{
+				lanes(tile, tile_end);
+			}
+
+			alignas(64) float ax[L::WIDTH], ay[L::WIDTH], ax_comp[L::WIDTH], ay_comp[L::WIDTH];
+			alignas(64) float heat_l[L::WIDTH], force[L::WIDTH], slot[L::WIDTH];
+			L::store(ax, acc.ax);
+			L::store(ay, acc.ay);
+			L::store(ax_comp, acc.ax_comp);
+			L::store(ay_comp, acc.ay_comp);
+			L::store(heat_l, acc.heat);
+			L::store(force, acc.max_force);
+			L::store(slot, acc.max_slot);
+
+			for (int l = 0; l < L::WIDTH; ++l)
+			{
+				sums.ax += static_cast<double>(ax[l]) - ax_comp[l];
+				sums.ay += static_cast<double>(ay[l]) - ay_comp[l];
+				sums.heat += heat_l[l];
+
+				const int s = static_cast<int>(slot[l]);
+				if (s >= 0 && (force[l] > sums.max_force || (force[l] == sums.max_force && (sums.max_slot < 0 || s < sums.max_slot))))
+				{
+					sums.max_force = force[l];
+					sums.max_slot = s;
+				}
+			}
+			sums.contact = sums.contact || L::any(acc.contact);
+		}
+	}
+}
+
+// Instantiation for the terms of the call, indexed by Terms::index()
+template <typename TargetOf>
+void MixedPairKernel::accumulateTerms(int n_targets, TargetOf target_of, PairKernel::Sums* out, PairKernel::Terms terms) const
+{
+	using Fn = void (MixedPairKernel::*)(int, TargetOf, PairKernel::Sums*) const;
+	static constexpr Fn table[] = {
+		&MixedPairKernel::accumulateTargets<false, false, TargetOf>, &MixedPairKernel::accumulateTargets<false, true, TargetOf>,
+		&MixedPairKernel::accumulateTargets<true, false, TargetOf>, &MixedPairKernel::accumulateTargets<true, true, TargetOf>
+	};
+	(this->*table[terms.index()])(n_targets, target_of, out);
+}
+
+void MixedPairKernel::accumulate(int i_begin, int i_end, PairKernel::Sums* out, PairKernel::Terms terms) const
+{
+	accumulateTerms(i_end - i_begin, [i_begin](int t) { return i_begin + t; }, out, terms);
+}
+
+void MixedPairKernel::accumulate(const int* targets, int n_targets, PairKernel::Sums* out, PairKernel::Terms terms) const
+{
+	accumulateTerms(n_targets, [targets](int t) { return targets[t]; }, out, terms);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <vector>
+
+#include "pair_kernel.h"
+
+/*
+ * Single-precision variant of PairKernel::accumulate, for GravityPrecision::MIXED.
+ *
+ * prepare() takes float copies of the store, with positions relative to the centre of the bodies'
+ * bounding box so the float mantissa is spent on separations rather than on the offset from the origin.
+ * Each pair costs one rsqrt estimate refined by a Newton step, on twice as many lanes as the double
+ * kernel. Accelerations are summed with Kahan compensation within a tile and in double across tiles.
+ * Contacts are flagged with a small margin, since the caller re-checks them exactly in double.
+ * Like the double kernel, the pair loop is instantiated per PairKernel::Terms.
+ */
+class MixedPairKernel
+{
+public:
+	void prepare(const BodyStore& store);
+	void accumulate(int i_begin, int i_end, PairKernel::Sums* out, PairKernel::Terms terms = {}) const;
+	void accumulate(const int* targets, int n_targets, PairKernel::Sums* out, PairKernel::Terms terms = {}) const;
+
+private:
+	template <bool Gravity, bool Heat, typename TargetOf>
+	void accumulateTargets(int n_targets, TargetOf target_of, PairKernel::Sums* out) const;
+
+	template <typename TargetOf>
+	void accumulateTerms(int n_targets, TargetOf target_of, PairKernel::Sums* out, PairKernel::Terms terms) const;
+
+	std::vector<float> x, y;
+	std::vector<float> g_mass;
+	std::vector<float> heat;
+	std::vector<float> reach;
+	int sources{ 0 };	// active slots of the store, see BodyStore::sources()
+};
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/*
+ * Space-filling-curve ordering of object arrays, so that objects close in space are also close in memory.
+ *
+ * Objects are keyed by their position along a Morton (Z-order) curve over the bounding box of the array and
+ * the array is physically permuted into key order. Sorting is only worth it once enough objects have moved
+ * out of order, so reorder() first measures the fraction of neighbouring objects that are out of order on a
+ * coarse version of the curve and leaves the array alone below the given threshold. Arrays too small to
+ * spill out of cache are never touched. Storage is kept between calls.
+ */
+class MortonOrder
+{
+public:
+	static constexpr size_t MIN_OBJECTS = 1024;
+	static constexpr size_t CELL_OBJECTS = 16;
+
+	/*
+	 * Interleaves the bits of two 32 bit grid coordinates, x in the even bits.
+	 */
+	[[nodiscard]] static uint64_t interleave(uint32_t x, uint32_t y) noexcept
+	{
+		return spread(x) | (spread(y) << 1);
+	}
+
+	/*
+	 * Sorts `items` along the curve if more than `max_disorder` of the neighbouring pairs are out of coarse
+	 * curve order. `position(item)` returns something with .x and .y. `scratch` receives the old elements and is
+	 * left empty with its capacity kept. Returns true if the array was reordered.
+	 */
+	template <typename T, typename PosFn>
+	bool reorder(std::vector<T>& items, PosFn&& position, double max_disorder, std::vector<T>& scratch);
+
+	[[nodiscard]] double lastDisorder() const noexcept { return last_disorder; }
+	[[nodiscard]] size_t sorts() const noexcept { return sort_count; }
+
+private:
+	std::vector<std::pair<uint64_t, uint32_t>> keys;	// curve key and current index of each object
+	double last_disorder{ 0.0 };
+	size_t sort_count{ 0 };
+
+	[[nodiscard]] static uint64_t spread(uint32_t v) noexcept
+	{
+		uint64_t x = v;
+		x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+		x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+		x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+		x = (x | (x << 2)) & 0x3333333333333333ull;
+		x = (x | (x << 1)) & 0x5555555555555555ull;
+		return x;
+	}
+};
+
+template <typename T, typename PosFn>
+bool MortonOrder::reorder(std::vector<T>& items, PosFn&& position, double max_disorder, std::vector<T>& scratch)
+{
+	const size_t n = items.size();
+	if (n < MIN_OBJECTS)
+		return false;
+
+	double min_x = position(items[0]).x, max_x = min_x;
+	double min_y = position(items[0]).y, max_y = min_y;
+	for (const T& item : items)
+	{
+		const auto p = position(item);
+		min_x = std::min(min_x, static_cast<double>(p.x));
+		max_x = std::max(max_x, static_cast<double>(p.x));
+		min_y = std::min(min_y, static_cast<double>(p.y));
+		max_y = std::max(max_y, static_cast<double>(p.y));
+	}
+
+	// One square frame, so the curve does not stretch along the longer side
+	const double extent = std::max({ max_x - min_x, max_y - min_y, 1e-9 });
+	const double scale = 4294967295.0 / extent;
+	const auto grid = [&](double v, double lo) {
+		return static_cast<uint32_t>(std::clamp((v - lo) * scale, 0.0, 4294967295.0));
+	};
+
+	// Disorder is counted on a coarser curve with about CELL_OBJECTS objects per cell, so bodies drifting
+	// within their neighbourhood do not count, only those that ended up next to a far away one
+	int cell_bits = 0;
+	while (cell_bits < 32 && (size_t{ 1 } << (2 * cell_bits)) * CELL_OBJECTS < n)
+		++cell_bits;
+	const int coarse_shift = 2 * (32 - cell_bits);
+
+	keys.clear();
+	size_t out_of_order = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		const auto p = position(items[i]);
+		keys.push_back({ interleave(grid(p.x, min_x), grid(p.y, min_y)), static_cast<uint32_t>(i) });
+		if (i > 0 && (keys[i].first >> coarse_shift) < (keys[i - 1].first >> coarse_shift))
+			++out_of_order;
+	}
+	last_disorder = static_cast<double>(out_of_order) / static_cast<double>(n - 1);
+	if (out_of_order == 0 || last_disorder < max_disorder)
+		return false;
+
+	// Equal keys keep their current order, so a sort of a sorted array is a no-op
+	std::sort(keys.begin(), keys.end());
+
+	scratch.clear();
+	scratch.reserve(n);
+	for (const auto& [key, index] : keys)
+		scratch.push_back(std::move(items[index]));
+	items.swap(scratch);
+	scratch.clear();
+	++sort_count;
+	return true;
+}
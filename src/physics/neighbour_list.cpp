@@ -0,0 +1,107 @@
+#include "neighbour_list.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+bool NeighbourList::update(const BodyStore& store, double skin)
+{
+	if (valid(store, skin))
+		return false;
+	build(store, skin);
+	return true;
+}
+
+bool NeighbourList::valid(const BodyStore& store, double skin) const
+{
+	const int n = store.size();
+	if (skin != built_skin || static_cast<int>(ids.size()) != n)
+		return false;
+
+	// A pair missing from the lists was at least reach_i + reach_j + skin apart, so it stays out of reach
+	// while neither body has used up half the skin by moving or growing its reach
+	const double half_skin = 0.5 * skin;
+	for (int k = 0; k < n; ++k)
+	{
+		if (store.id[k] != ids[k] || !stillNear(store, half_skin, k))
+			return false;
+	}
+	return true;
+}
+
+bool NeighbourList::valid(const BodyStore& store, double skin, std::span<const int> slots) const
+{
+	if (skin != built_skin || static_cast<int>(ids.size()) != store.size())
+		return false;
+
+	const double half_skin = 0.5 * skin;
+	for (const int k : slots)
+	{
+		if (!stillNear(store, half_skin, k))
+			return false;
+	}
+	return true;
+}
+
+bool NeighbourList::stillNear(const BodyStore& store, double half_skin, int k) const
+{
+	const double moved = std::hypot(store.x[k] - built_x[k], store.y[k] - built_y[k]);
+	return moved + std::max(store.reach[k] - built_reach[k], 0.0) <= half_skin;
+}
+
+void NeighbourList::build(const BodyStore& store, double skin)
+{
+	const int n = store.size();
+	++rebuild_count;
+	built_skin = skin;
+	ids.assign(store.id.begin(), store.id.end());
+	built_x.assign(store.x.begin(), store.x.end());
+	built_y.assign(store.y.begin(), store.y.end());
+	built_reach.assign(store.reach.begin(), store.reach.end());
+
+	const double max_reach = n > 0 ? *std::max_element(store.reach.begin(), store.reach.end()) : 0.0;
+
+	// Sweep along x: partners of i lie within reach_i + max_reach + skin of it on that axis
+	order.resize(n);
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&](int a, int b) { return store.x[a] < store.x[b]; });
+
+	pairs.clear();
+	for (int a = 0; a < n; ++a)
+	{
+		const int i = order[a];
+		const double window = store.reach[i] + max_reach + skin;
+		for (int b = a + 1; b < n; ++b)
+		{
+			const int j = order[b];
+			const double dx = store.x[j] - store.x[i];
+			if (dx > window) break;
+			const double dy = store.y[j] - store.y[i];
+			const double cutoff = store.reach[i] + store.reach[j] + skin;
+			if (dx * dx + dy * dy < cutoff * cutoff)
+				pairs.emplace_back(i, j);
+		}
+	}
+
+	// Both directions of each pair, stored by slot
+	offset.assign(n + 1, 0);
+	for (const auto& [i, j] : pairs)
+	{
+		++offset[i + 1];
+		++offset[j + 1];
+	}
+	for (int k = 0; k < n; ++k)
+		offset[k + 1] += offset[k];
+
+	neighbours.resize(offset[n]);
+	fill.assign(offset.begin(), offset.end() - 1);
+	for (const auto& [i, j] : pairs)
+	{
+		neighbours[fill[i]++] = j;
+		neighbours[fill[j]++] = i;
+	}
+
+	// Slot order, so events are checked in the same order as a scan over all bodies
+	for (int k = 0; k < n; ++k)
+		std::sort(neighbours.begin() + offset[k], neighbours.begin() + offset[k + 1]);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "body_store.h"
+
+/*
+ * Verlet neighbour lists for the collision and Roche checks in Space::update().
+ *
+ * Each body lists the bodies within reach_i + reach_j + skin of it. The lists stay valid until some body
+ * has moved, or had its reach grow, by more than half the skin since they were built, so most passes
+ * only check the few listed pairs instead of every pair. Slots are matched to bodies by id, so the lists
+ * also survive between ticks as long as no body is added or removed.
+ */
+class NeighbourList
+{
+public:
+	/*
+	 * Makes sure the lists hold every pair of the store within reach_i + reach_j of each other, rebuilding
+	 * them if needed. Returns true if they were rebuilt.
+	 */
+	bool update(const BodyStore& store, double skin);
+
+	/*
+	 * Checks the lists for the given slots only, against lists built for the same slots and skin. Meant for
+	 * passes that evaluate a few bodies between full updates: their event checks only see the listed pairs
+	 * of those slots, and bodies outside them are checked again by the next update().
+	 */
+	[[nodiscard]] bool valid(const BodyStore& store, double skin, std::span<const int> slots) const;
+
+	/*
+	 * Slots that may be within reach of slot k, in ascending order.
+	 */
+	[[nodiscard]] std::span<const int> of(int k) const
+	{
+		return { neighbours.data() + offset[k], neighbours.data() + offset[k + 1] };
+	}
+
+	[[nodiscard]] size_t rebuilds() const noexcept { return rebuild_count; }
+
+private:
+	std::vector<int> ids;			// body in each slot when the lists were built
+	std::vector<double> built_x, built_y, built_reach;
+	double built_skin{ -1.0 };
+
+	std::vector<int> offset;		// neighbours of slot k are neighbours[offset[k] .. offset[k + 1])
+	std::vector<int> neighbours;
+	std::vector<int> fill;			// next free entry of each slot while the lists are filled
+
+	std::vector<int> order;
+	std::vector<std::pair<int, int>> pairs;
+	size_t rebuild_count{ 0 };
+
+	[[nodiscard]] bool valid(const BodyStore& store, double skin) const;
+	[[nodiscard]] bool stillNear(const BodyStore& store, double half_skin, int k) const;
+	void build(const BodyStore& store, double skin);
+};
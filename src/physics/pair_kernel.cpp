@@ -0,0 +1,269 @@
+#include "pair_kernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simd_lanes.h"
+
+namespace {
+
+// Per-lane running sums of one target body over a tile
+struct LaneSums
+{
+	SimdLanes::V ax, ay, heat, max_force, max_slot;
+	SimdLanes::M contact;
+};
+
+struct Target
+{
+	double x, y, reach;
+};
+
+template <bool Gravity, bool Heat>
+void accumulateRange(const BodyStore& s, const Target& t, int j_begin, int j_end, LaneSums& acc, PairKernel::Sums& out)
+{
+	using L = SimdLanes;
+	const L::V xi = L::set(t.x);
+	const L::V yi = L::set(t.y);
+	const L::V reach_i = L::set(t.reach);
+	const L::V min_d2 = L::set(0.01);
+	const L::V one = L::set(1.0);
+
+	const double* px = s.x.data();
+	const double* py = s.y.data();
+	const double* pg = s.g_mass.data();
+	const double* ph = s.heat.data();
+	const double* pr = s.reach.data();
+
+	int j = j_begin;
+	for (; j + L::WIDTH <= j_end; j += L::WIDTH)
+	{
+		const L::V dx = L::sub(L::load(px + j), xi);
+		const L::V dy = L::sub(L::load(py + j), yi);
+		const L::V d2 = L::max(L::fma(dx, dx, L::mul(dy, dy)), min_d2);
+
+		// One square root and one division per pair, everything else is derived from 1/dist
+		if constexpr (Gravity || Heat)
+		{
+			const L::V inv_d = L::div(one, L::sqrt(d2));
+			if constexpr (Gravity)
+			{
+				const L::V force = L::mul(L::load(pg + j), L::mul(inv_d, inv_d));
+				const L::V factor = L::mul(force, inv_d);
+				acc.ax = L::fma(factor, dx, acc.ax);
+				acc.ay = L::fma(factor, dy, acc.ay);
+
+				const L::M stronger = L::greater(force, acc.max_force);
+				acc.max_force = L::select(stronger, force, acc.max_force);
+				acc.max_slot = L::select(stronger, L::iota(static_cast<double>(j)), acc.max_slot);
+			}
+			if constexpr (Heat)
+				acc.heat = L::fma(L::load(ph + j), L::min(inv_d, one), acc.heat);
+		}
+
+		const L::V contact_range = L::add(reach_i, L::load(pr + j));
+		acc.contact = L::either(acc.contact, L::less(d2, L::mul(contact_range, contact_range)));
+	}
+
+	// Remainder, in the same order so the first strongest slot is kept
+	for (; j < j_end; ++j)
+	{
+		const double dx = px[j] - t.x;
+		const double dy = py[j] - t.y;
+		const double d2 = std::max(dx * dx + dy * dy, 0.01);
+		if constexpr (Gravity || Heat)
+		{
+			const double inv_d = 1.0 / std::sqrt(d2);
+			if constexpr (Gravity)
+			{
+				const double force = pg[j] * inv_d * inv_d;
+				out.ax += force * inv_d * dx;
+				out.ay += force * inv_d * dy;
+				if (force > out.max_force || (force == out.max_force && out.max_slot > j))
+				{
+					out.max_force = force;
+					out.max_slot = j;
+				}
+			}
+			if constexpr (Heat)
+				out.heat += ph[j] * std::min(inv_d, 1.0);
+		}
+		const double contact_range = t.reach + pr[j];
+		out.contact = out.contact || d2 < contact_range * contact_range;
+	}
+}
+
+void reduceLanes(const LaneSums& acc, PairKernel::Sums& out)
+{
+	alignas(64) double ax[SimdLanes::WIDTH], ay[SimdLanes::WIDTH], heat[SimdLanes::WIDTH], force[SimdLanes::WIDTH], slot[SimdLanes::WIDTH];
+	SimdLanes::store(ax, acc.ax);
+	SimdLanes::store(ay, acc.ay);
+	SimdLanes::store(heat, acc.heat);
+	SimdLanes::store(force, acc.max_force);
+	SimdLanes::store(slot, acc.max_slot);
+
+	for (int l = 0; l < SimdLanes::WIDTH; ++l)
+	{
+		out.ax += ax[l];
+		out.ay += ay[l];
+		out.heat += heat[l];
+
+		const int s = static_cast<int>(slot[l]);
+		if (s >= 0 && (force[l] > out.max_force || (force[l] == out.max_force && (out.max_slot < 0 || s < out.max_slot))))
+		{
+			out.max_force = force[l];
+			out.max_slot = s;
+		}
+	}
+	out.contact = out.contact || SimdLanes::any(acc.contact);
+}
+
+// Shared by both overloads: target_of(t) is the store slot of the t-th body to evaluate
+template <bool Gravity, bool Heat, typename TargetOf>
+void accumulateTargets(const BodyStore& store, int n_targets, TargetOf target_of, PairKernel::Sums* out)
+{
+	const int n = store.sources();
+	for (int t = 0; t < n_targets; ++t)
+		out[t] = PairKernel::Sums{};
+
+	for (int tile = 0; tile < n; tile += PairKernel::TILE)
+	{
+		const int tile_end = std::min(tile + PairKernel::TILE, n);
+
+		for (int t = 0; t < n_targets; ++t)
+		{
+			const int i = target_of(t);
+			const Target target{ store.x[i], store.y[i], store.reach[i] };
+			LaneSums acc{ SimdLanes::set(0.0), SimdLanes::set(0.0), SimdLanes::set(0.0), SimdLanes::set(0.0), SimdLanes::set(-1.0), SimdLanes::none() };
+			PairKernel::Sums& sums = out[t];
+
+			// Split the tile around i instead of testing for the self pair
+			if (i >= tile && i < tile_end)
+			{
+				accumulateRange<Gravity, Heat>(store, target, tile, i, acc, sums);
+				accumulateRange<Gravity, Heat>(store, target, i + 1, tile_end, acc, sums);
+			}
+			else
+			{
+				accumulateRange<Gravity, Heat>(store, target, tile, tile_end, acc, sums);
+			}
+			reduceLanes(acc, sums);
+		}
+	}
+}
+
+// Instantiation for the terms of the call, indexed by Terms::index()
+template <typename TargetOf>
+void accumulateTerms(const BodyStore& store, int n_targets, TargetOf target_of, PairKernel::Sums* out, PairKernel::Terms terms)
+{
+	using Fn = void (*)(const BodyStore&, int, TargetOf, PairKernel::Sums*);
+	static constexpr Fn table[] = {
+		&accumulateTargets<false, false, TargetOf>, &accumulateTargets<false, true, TargetOf>,
+		&accumulateTargets<true, false, TargetOf>, &accumulateTargets<true, true, TargetOf>
+	};
+	table[terms.index()](store, n_targets, target_of, out);
+}
+
+// d/dt of g_mass_j * r / |r|^3 is g_mass_j * (v / |r|^3 - 3 (r.v) r / |r|^5), with r and v relative to body i
+void accumulateJerkRange(const BodyStore& s, int i, int j_begin, int j_end, SimdLanes::V& jx, SimdLanes::V& jy, double& out_x, double& out_y)
+{
+	using L = SimdLanes;
+	const L::V xi = L::set(s.x[i]), yi = L::set(s.y[i]);
+	const L::V vxi = L::set(s.vx[i]), vyi = L::set(s.vy[i]);
+	const L::V min_d2 = L::set(0.01);
+	const L::V one = L::set(1.0);
+	const L::V three = L::set(3.0);
+
+	int j = j_begin;
+	for (; j + L::WIDTH <= j_end; j += L::WIDTH)
+	{
+		const L::V dx = L::sub(L::load(s.x.data() + j), xi);
+		const L::V dy = L::sub(L::load(s.y.data() + j), yi);
+		const L::V dvx = L::sub(L::load(s.vx.data() + j), vxi);
+		const L::V dvy = L::sub(L::load(s.vy.data() + j), vyi);
+		const L::V d2 = L::max(L::fma(dx, dx, L::mul(dy, dy)), min_d2);
+		const L::V inv_d2 = L::div(one, d2);
+		const L::V factor = L::mul(L::load(s.g_mass.data() + j), L::mul(inv_d2, L::sqrt(inv_d2)));
+		const L::V radial = L::mul(three, L::mul(L::fma(dx, dvx, L::mul(dy, dvy)), inv_d2));
+		jx = L::fma(factor, L::sub(dvx, L::mul(radial, dx)), jx);
+		jy = L::fma(factor, L::sub(dvy, L::mul(radial, dy)), jy);
+	}
+
+	for (; j < j_end; ++j)
+	{
+		const double dx = s.x[j] - s.x[i];
+		const double dy = s.y[j] - s.y[i];
+		const double dvx = s.vx[j] - s.vx[i];
+		const double dvy = s.vy[j] - s.vy[i];
+		const double d2 = std::max(dx * dx + dy * dy, 0.01);
+		const double factor = s.g_mass[j] / (d2 * std::sqrt(d2));
+		const double radial = 3.0 * (dx * dvx + dy * dvy) / d2;
+		out_x += factor * (dvx - radial * dx);
+		out_y += factor * (dvy - radial * dy);
+	}
+}
+
+}
+
+namespace PairKernel
+{
+	void accumulate(const BodyStore& store, int i_begin, int i_end, Sums* out, Terms terms)
+	{
+		accumulateTerms(store, i_end - i_begin, [i_begin](int t) { return i_begin + t; }, out, terms);
+	}
+
+	void accumulate(const BodyStore& store, const int* targets, int n_targets, Sums* out, Terms terms)
+	{
+		accumulateTerms(store, n_targets, [targets](int t) { return targets[t]; }, out, terms);
+	}
+
+	void accumulateJerk(const BodyStore& store, int i_begin, int i_end, double* jx, double* jy)
+	{
+		const int n = store.sources();
+		for (int i = i_begin; i < i_end; ++i)
+		{
+			SimdLanes::V lanes_x = SimdLanes::set(0.0), lanes_y = SimdLanes::set(0.0);
+			double sum_x = 0.0, sum_y = 0.0;
+			accumulateJerkRange(store, i, 0, std::min(i, n), lanes_x, lanes_y, sum_x, sum_y);
+			accumulateJerkRange(store, i, i + 1, n, lanes_x, lanes_y, sum_x, sum_y);
+
+			alignas(64) double lane_x[SimdLanes::WIDTH], lane_y[SimdLanes::WIDTH];
+			SimdLanes::store(lane_x, lanes_x);
+			SimdLanes::store(lane_y, lanes_y);
+			for (int l = 0; l < SimdLanes::WIDTH; ++l)
+			{
+				sum_x += lane_x[l];
+				sum_y += lane_y[l];
+			}
+			jx[i - i_begin] = sum_x;
+			jy[i - i_begin] = sum_y;
+		}
+	}
+
+	void removeFamilyJerk(const BodyStore& s, int i_begin, int i_end, double* jx, double* jy)
+	{
+		for (int i = i_begin; i < i_end; ++i)
+		{
+			if (s.family[i] < 0) continue;
+
+			for (int j = 0; j < s.sources(); ++j)
+			{
+				if (j == i || s.family[j] != s.family[i]) continue;
+				const double dx = s.x[j] - s.x[i];
+				const double dy = s.y[j] - s.y[i];
+				const double dvx = s.vx[j] - s.vx[i];
+				const double dvy = s.vy[j] - s.vy[i];
+				const double d2 = std::max(dx * dx + dy * dy, 0.01);
+				const double factor = s.g_mass[j] / (d2 * std::sqrt(d2));
+				const double radial = 3.0 * (dx * dvx + dy * dvy) / d2;
+				jx[i - i_begin] -= factor * (dvx - radial * dx);
+				jy[i - i_begin] -= factor * (dvy - radial * dy);
+			}
+		}
+	}
+
+	const char* instructionSet()
+	{
+		return SimdLanes::NAME;
+	}
+}
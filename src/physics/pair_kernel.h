@@ -0,0 +1,85 @@
+#pragma once
+
+#include <type_traits>
+
+#include "body_store.h"
+
+/*
+ * Vectorized direct-sum gravity and heat kernel over a BodyStore.
+ *
+ * The j loop is tiled so a block of bodies stays in L1 while it is applied to every body of an i block,
+ * and each tile is processed 8 (AVX-512), 4 (AVX2) or 2 (SSE2) bodies per instruction.
+ * Collisions and Roche breakups are not resolved here: the kernel only flags bodies that have a
+ * neighbour within reach, and the caller re-checks those pairs exactly.
+ * The pair loop is compiled once per combination of Terms, and each call picks its instantiation from
+ * a table, so a term that is switched off costs nothing per pair.
+ */
+namespace PairKernel
+{
+	inline constexpr int TILE = 512;
+
+	/*
+	 * Terms a pass needs. Sums of a term that is off are left at zero (max_slot at -1).
+	 */
+	struct Terms
+	{
+		bool gravity{ true };
+		bool heat{ true };
+
+		[[nodiscard]] constexpr int index() const noexcept { return (gravity ? 2 : 0) + (heat ? 1 : 0); }
+	};
+
+	struct Sums
+	{
+		double ax{ 0.0 };
+		double ay{ 0.0 };
+		double heat{ 0.0 };			// sum of heat_j / max(dist, 1)
+		double max_force{ 0.0 };	// largest g_mass_j / dist^2
+		int max_slot{ -1 };			// lowest slot reaching max_force
+		bool contact{ false };		// some body is within reach_i + reach_j
+	};
+
+	/*
+	 * Calls fn(std::bool_constant<gravity>, std::bool_constant<heat>) for the given terms, so that callers can
+	 * compile their own pair loops per combination and pick one once per pass.
+	 */
+	template <typename Fn>
+	decltype(auto) withTerms(Terms terms, Fn&& fn)
+	{
+		switch (terms.index())
+		{
+		case 0: return fn(std::false_type{}, std::false_type{});
+		case 1: return fn(std::false_type{}, std::true_type{});
+		case 2: return fn(std::true_type{}, std::false_type{});
+		default: return fn(std::true_type{}, std::true_type{});
+		}
+	}
+
+	/*
+	 * Fills out[0 .. i_end - i_begin) with the sums over all other active bodies of the store. Passive
+	 * bodies neither pull nor flag contacts, so callers with passive bodies check their neighbour lists.
+	 */
+	void accumulate(const BodyStore& store, int i_begin, int i_end, Sums* out, Terms terms = {});
+
+	/*
+	 * Same for an arbitrary set of slots: fills out[0 .. n_targets) for targets[0 .. n_targets).
+	 */
+	void accumulate(const BodyStore& store, const int* targets, int n_targets, Sums* out, Terms terms = {});
+
+	/*
+	 * Time derivative of the acceleration of slots [i_begin, i_end) from all other active bodies, with the same
+	 * softening as the forces. Fills jx / jy[0 .. i_end - i_begin). Used by the Hermite integrator.
+	 */
+	void accumulateJerk(const BodyStore& store, int i_begin, int i_end, double* jx, double* jy);
+
+	/*
+	 * Takes the jerk from the body's own fragment family back out of jx / jy[0 .. i_end - i_begin), filled by
+	 * accumulateJerk(), since the force passes ignore those pairs. Bodies without a family are left as they are.
+	 */
+	void removeFamilyJerk(const BodyStore& store, int i_begin, int i_end, double* jx, double* jy);
+
+	/*
+	 * Instruction set the kernel was compiled for.
+	 */
+	const char* instructionSet();
+}
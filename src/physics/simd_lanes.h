@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+/*
+ * Thin wrappers over the widest vectors the build targets, so the physics kernels are written once.
+ * SimdLanes holds doubles, SimdLanesF twice as many floats. The instruction set follows the compiler
+ * flags (GRAVITY_SIM_SIMD in CMakeLists.txt).
+ */
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX512F__)
+struct SimdLanes
+{
+	static constexpr int WIDTH = 8;
+	static constexpr const char* NAME = "AVX-512";
+	using V = __m512d;
+	using M = __mmask8;
+
+	static V load(const double* p) { return _mm512_loadu_pd(p); }
+	static V set(double v) { return _mm512_set1_pd(v); }
+	static V iota(double base) { return _mm512_add_pd(_mm512_set1_pd(base), _mm512_set_pd(7, 6, 5, 4, 3, 2, 1, 0)); }
+	static V add(V a, V b) { return _mm512_add_pd(a, b); }
+	static V sub(V a, V b) { return _mm512_sub_pd(a, b); }
+	static V mul(V a, V b) { return _mm512_mul_pd(a, b); }
+	static V fma(V a, V b, V c) { return _mm512_fmadd_pd(a, b, c); }
+	static V div(V a, V b) { return _mm512_div_pd(a, b); }
+	static V sqrt(V a) { return _mm512_sqrt_pd(a); }
+	static V max(V a, V b) { return _mm512_max_pd(a, b); }
+	static V min(V a, V b) { return _mm512_min_pd(a, b); }
+	static M less(V a, V b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+	static M greater(V a, V b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+	static M equal(V a, V b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+	static M none() { return 0; }
+	static M either(M a, M b) { return a | b; }
+	static M both(M a, M b) { return a & b; }
+	static bool any(M m) { return m != 0; }
+	static V select(M m, V a, V b) { return _mm512_mask_blend_pd(m, b, a); }
+	static void store(double* p, V v) { _mm512_storeu_pd(p, v); }
+};
+#elif defined(__AVX2__)
+struct SimdLanes
+{
+	static constexpr int WIDTH = 4;
+	static constexpr const char* NAME = "AVX2";
+	using V = __m256d;
+	using M = __m256d;
+
+	static V load(const double* p) { return _mm256_loadu_pd(p); }
+	static V set(double v) { return _mm256_set1_pd(v); }
+	static V iota(double base) { return _mm256_add_pd(_mm256_set1_pd(base), _mm256_set_pd(3, 2, 1, 0)); }
+	static V add(V a, V b) { return _mm256_add_pd(a, b); }
+	static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+	static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+	static V fma(V a, V b, V c) { return _mm256_fmadd_pd(a, b, c); }
+	static V div(V a, V b) { return _mm256_div_pd(a, b); }
+	static V sqrt(V a) { return _mm256_sqrt_pd(a); }
+	static V max(V a, V b) { return _mm256_max_pd(a, b); }
+	static V min(V a, V b) { return _mm256_min_pd(a, b); }
+	static M less(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+	static M greater(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+	static M equal(V a, V b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+	static M none() { return _mm256_setzero_pd(); }
+	static M either(M a, M b) { return _mm256_or_pd(a, b); }
+	static M both(M a, M b) { return _mm256_and_pd(a, b); }
+	static bool any(M m) { return _mm256_movemask_pd(m) != 0; }
+	static V select(M m, V a, V b) { return _mm256_blendv_pd(b, a, m); }
+	static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+struct SimdLanes
+{
+	static constexpr int WIDTH = 2;
+	static constexpr const char* NAME = "SSE2";
+	using V = __m128d;
+	using M = __m128d;
+
+	static V load(const double* p) { return _mm_loadu_pd(p); }
+	static V set(double v) { return _mm_set1_pd(v); }
+	static V iota(double base) { return _mm_add_pd(_mm_set1_pd(base), _mm_set_pd(1, 0)); }
+	static V add(V a, V b) { return _mm_add_pd(a, b); }
+	static V sub(V a, V b) { return _mm_sub_pd(a, b); }
+	static V mul(V a, V b) { return _mm_mul_pd(a, b); }
+	static V fma(V a, V b, V c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+	static V div(V a, V b) { return _mm_div_pd(a, b); }
+	static V sqrt(V a) { return _mm_sqrt_pd(a); }
+	static V max(V a, V b) { return _mm_max_pd(a, b); }
+	static V min(V a, V b) { return _mm_min_pd(a, b); }
+	static M less(V a, V b) { return _mm_cmplt_pd(a, b); }
+	static M greater(V a, V b) { return _mm_cmpgt_pd(a, b); }
+	static M equal(V a, V b) { return _mm_cmpeq_pd(a, b); }
+	static M none() { return _mm_setzero_pd(); }
+	static M either(M a, M b) { return _mm_or_pd(a, b); }
+	static M both(M a, M b) { return _mm_and_pd(a, b); }
+	static bool any(M m) { return _mm_movemask_pd(m) != 0; }
+	static V select(M m, V a, V b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+	static void store(double* p, V v) { _mm_storeu_pd(p, v); }
+};
+#else
+struct SimdLanes
+{
+	static constexpr int WIDTH = 1;
+	static constexpr const char* NAME = "scalar";
+	using V = double;
+	using M = bool;
+
+	static V load(const double* p) { return *p; }
+	static V set(double v) { return v; }
+	static V iota(double base) { return base; }
+	static V add(V a, V b) { return a + b; }
+	static V sub(V a, V b) { return a - b; }
+	static V mul(V a, V b) { return a * b; }
+	static V fma(V a, V b, V c) { return a * b + c; }
+	static V div(V a, V b) { return a / b; }
+	static V sqrt(V a) { return std::sqrt(a); }
+	static V max(V a, V b) { return std::max(a, b); }
+	static V min(V a, V b) { return std::min(a, b); }
+	static M less(V a, V b) { return a < b; }
+	static M greater(V a, V b) { return a > b; }
+	static M equal(V a, V b) { return a == b; }
+	static M none() { return false; }
+	static M either(M a, M b) { return a || b; }
+	static M both(M a, M b) { return a && b; }
+	static bool any(M m) { return m; }
+	static V select(M m, V a, V b) { return m ? a : b; }
+	static void store(double* p, V v) { *p = v; }
+};
+#endif
+
+#if defined(__AVX512F__)
+struct SimdLanesF
+{
+	static constexpr int WIDTH = 16;
+	using V = __m512;
+	using M = __mmask16;
+
+	static V load(const float* p) { return _mm512_loadu_ps(p); }
+	static V set(float v) { return _mm512_set1_ps(v); }
+	static V iota(float base) { return _mm512_add_ps(_mm512_set1_ps(base), _mm512_set_ps(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)); }
+	static V add(V a, V b) { return _mm512_add_ps(a, b); }
+	static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+	static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+	static V fma(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+	static V rsqrt(V a) { return _mm512_rsqrt14_ps(a); }
+	static V abs(V a) { return _mm512_abs_ps(a); }
+	static V max(V a, V b) { return _mm512_max_ps(a, b); }
+	static V min(V a, V b) { return _mm512_min_ps(a, b); }
+	static M less(V a, V b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+	static M greater(V a, V b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+	static M none() { return 0; }
+	static M either(M a, M b) { return a | b; }
+	static bool any(M m) { return m != 0; }
+	static V select(M m, V a, V b) { return _mm512_mask_blend_ps(m, b, a); }
+	static void store(float* p, V v) { _mm512_storeu_ps(p, v); }
+};
+#elif defined(__AVX2__)
+struct SimdLanesF
+{
+	static constexpr int WIDTH = 8;
+	using V = __m256;
+	using M = __m256;
+
+	static V load(const float* p) { return _mm256_loadu_ps(p); }
+	static V set(float v) { return _mm256_set1_ps(v); }
+	static V iota(float base) { return _mm256_add_ps(_mm256_set1_ps(base), _mm256_set_ps(7, 6, 5, 4, 3, 2, 1, 0)); }
+	static V add(V a, V b) { return _mm256_add_ps(a, b); }
+	static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+	static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+	static V fma(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+	static V rsqrt(V a) { return _mm256_rsqrt_ps(a); }
+	static V abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+	static V max(V a, V b) { return _mm256_max_ps(a, b); }
+	static V min(V a, V b) { return _mm256_min_ps(a, b); }
+	static M less(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static M greater(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	static M none() { return _mm256_setzero_ps(); }
+	static M either(M a, M b) { return _mm256_or_ps(a, b); }
+	static bool any(M m) { return _mm256_movemask_ps(m) != 0; }
+	static V select(M m, V a, V b) { return _mm256_blendv_ps(b, a, m); }
+	static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+struct SimdLanesF
+{
+	static constexpr int WIDTH = 4;
+	using V = __m128;
+	using M = __m128;
+
+	static V load(const float* p) { return _mm_loadu_ps(p); }
+	static V set(float v) { return _mm_set1_ps(v); }
+	static V iota(float base) { return _mm_add_ps(_mm_set1_ps(base), _mm_set_ps(3, 2, 1, 0)); }
+	static V add(V a, V b) { return _mm_add_ps(a, b); }
+	static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+	static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+	static V fma(V a, V b, V c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	static V rsqrt(V a) { return _mm_rsqrt_ps(a); }
+	static V abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+	static V max(V a, V b) { return _mm_max_ps(a, b); }
+	static V min(V a, V b) { return _mm_min_ps(a, b); }
+	static M less(V a, V b) { return _mm_cmplt_ps(a, b); }
+	static M greater(V a, V b) { return _mm_cmpgt_ps(a, b); }
+	static M none() { return _mm_setzero_ps(); }
+	static M either(M a, M b) { return _mm_or_ps(a, b); }
+	static bool any(M m) { return _mm_movemask_ps(m) != 0; }
+	static V select(M m, V a, V b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+	static void store(float* p, V v) { _mm_storeu_ps(p, v); }
+};
+#else
+struct SimdLanesF
+{
+	static constexpr int WIDTH = 1;
+	using V = float;
+	using M = bool;
+
+	static V load(const float* p) { return *p; }
+	static V set(float v) { return v; }
+	static V iota(float base) { return base; }
+	static V add(V a, V b) { return a + b; }
+	static V sub(V a, V b) { return a - b; }
+	static V mul(V a, V b) { return a * b; }
+	static V fma(V a, V b, V c) { return a * b + c; }
+	static V rsqrt(V a) { return 1.0f / std::sqrt(a); }
+	static V abs(V a) { return std::abs(a); }
+	static V max(V a, V b) { return std::max(a, b); }
+	static V min(V a, V b) { return std::min(a, b); }
+	static M less(V a, V b) { return a < b; }
+	static M greater(V a, V b) { return a > b; }
+	static M none() { return false; }
+	static M either(M a, M b) { return a || b; }
+	static bool any(M m) { return m; }
+	static V select(M m, V a, V b) { return m ? a : b; }
+	static void store(float* p, V v) { *p = v; }
+};
+#endif
@@ -0,0 +1,104 @@
+#include "spatial_index.h"
+
+void SpatialIndex::clear()
+{
+	count = 0;
+	cols = rows = 0;
+	max_small_radius = 0.0;
+	cell_start.clear();
+	cells.clear();
+	large.clear();
+}
+
+void SpatialIndex::build(const std::vector<Entry>& source)
+{
+	clear();
+	count = source.size();
+	if (source.empty())
+		return;
+
+	double max_x = source[0].x, max_y = source[0].y;
+	min_x = source[0].x;
+	min_y = source[0].y;
+	radii.clear();
+	for (const Entry& e : source)
+	{
+		min_x = std::min(min_x, e.x);
+		min_y = std::min(min_y, e.y);
+		max_x = std::max(max_x, e.x);
+		max_y = std::max(max_y, e.y);
+		radii.push_back(e.radius);
+	}
+
+	// Cells a few typical discs wide, but no more cells than about twice the discs. The area bound alone
+	// fails for flat layouts (all discs on a line have no area), so neither side gets more than
+	// sqrt(2N) cells either.
+	const auto median = radii.begin() + radii.size() / 2;
+	std::nth_element(radii.begin(), median, radii.end());
+	const double width = max_x - min_x;
+	const double height = max_y - min_y;
+	const double max_side_cells = std::ceil(std::sqrt(2.0 * static_cast<double>(source.size())));
+	cell_size = std::max({ 4.0 * *median, std::sqrt(width * height / (2.0 * static_cast<double>(source.size()))),
+		std::max(width, height) / max_side_cells, 1.0 });
+	cols = static_cast<int>(std::min(width / cell_size, max_side_cells)) + 1;
+	rows = static_cast<int>(std::min(height / cell_size, max_side_cells)) + 1;
+
+	// Counting sort of the grid discs by cell
+	cell_start.assign(static_cast<size_t>(cols) * rows + 1, 0);
+	for (const Entry& e : source)
+	{
+		if (e.radius > cell_size) continue;
+		++cell_start[row(e.y) * cols + column(e.x) + 1];
+	}
+	for (size_t c = 1; c < cell_start.size(); ++c)
+		cell_start[c] += cell_start[c - 1];
+
+	cells.resize(cell_start.back());
+	fill.assign(cell_start.begin(), cell_start.end() - 1);
+	for (const Entry& e : source)
+	{
+		if (e.radius > cell_size)
+		{
+			large.push_back(e);
+			continue;
+		}
+		cells[fill[row(e.y) * cols + column(e.x)]++] = e;
+		max_small_radius = std::max(max_small_radius, e.radius);
+	}
+}
+
+void SpatialIndex::nearest(double x, double y, int k, double max_dist, std::vector<Entry>& out) const
+{
+	out.clear();
+	if (count == 0 || k <= 0)
+		return;
+
+	// Every centre, large discs included, lies within the grid's bounds
+	const double reach = std::min(max_dist, std::hypot(std::max(std::abs(x - min_x), std::abs(x - (min_x + cols * cell_size))),
+		std::max(std::abs(y - min_y), std::abs(y - (min_y + rows * cell_size)))));
+
+	// Widen the search until it holds k centres, then keep the closest k
+	const auto by_distance = [&](const Entry& a, const Entry& b) {
+		const double da = (a.x - x) * (a.x - x) + (a.y - y) * (a.y - y);
+		const double db = (b.x - x) * (b.x - x) + (b.y - y) * (b.y - y);
+		return da != db ? da < db : a.item < b.item;
+	};
+	for (double radius = std::min(cell_size, reach); ; radius = std::min(2.0 * radius, reach))
+	{
+		out.clear();
+		forEachInBox(x - radius, y - radius, x + radius, y + radius, [&](const Entry& e) {
+			const double dx = e.x - x;
+			const double dy = e.y - y;
+			if (dx * dx + dy * dy <= radius * radius)
+				out.push_back(e);
+		});
+		if (static_cast<int>(out.size()) >= k || radius >= reach)
+			break;
+	}
+
+	// The box query keeps the boundary, the caller's limit is exclusive like a strict distance check
+	std::erase_if(out, [&](const Entry& e) { return std::hypot(e.x - x, e.y - y) >= max_dist; });
+	const auto last = out.begin() + std::min<size_t>(out.size(), k);
+	std::partial_sort(out.begin(), last, out.end(), by_distance);
+	out.erase(last, out.end());
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+/*
+ * Uniform grid over a set of discs, shared by the proximity queries of the game (ship, projectiles,
+ * missiles, dust removal, mouse picking).
+ *
+ * Each disc is stored in the cell holding its centre, so a query only visits the cells around it.
+ * Discs much larger than a cell (stars next to dust-sized rocks) are kept in a separate list that every
+ * query checks, so the cell size can follow the typical disc instead of the largest one.
+ * The queries are read-only and may run from several threads at once.
+ */
+class SpatialIndex
+{
+public:
+	struct Entry
+	{
+		double x, y;
+		double radius;
+		int item;		// index into the caller's objects
+	};
+
+	/*
+	 * Rebuilds the grid. Storage is kept between calls, so a steady-state rebuild does not allocate.
+	 */
+	void build(const std::vector<Entry>& source);
+
+	void clear();
+
+	[[nodiscard]] size_t size() const noexcept { return count; }
+
+	/*
+	 * Calls fn(const Entry&) for every disc that touches the circle around (x, y), i.e. whose centre is
+	 * at most radius + entry.radius away.
+	 */
+	template <typename Fn>
+	void queryCircle(double x, double y, double radius, Fn&& fn) const;
+
+	/*
+	 * Calls fn(const Entry&) for every disc that comes within `radius` of the segment from (ax, ay) to (bx, by).
+	 */
+	template <typename Fn>
+	void querySegment(double ax, double ay, double bx, double by, double radius, Fn&& fn) const;
+
+	/*
+	 * The k discs with the closest centres to (x, y), no further than max_dist, closest first.
+	 * Ties go to the lower item.
+	 */
+	void nearest(double x, double y, int k, double max_dist, std::vector<Entry>& out) const;
+
+private:
+	double min_x{ 0.0 }, min_y{ 0.0 };
+	double cell_size{ 1.0 };
+	double max_small_radius{ 0.0 };	// largest disc kept in the grid
+	int cols{ 0 }, rows{ 0 };
+	size_t count{ 0 };
+
+	std::vector<int> cell_start;	// entries of cell c are cells[cell_start[c] .. cell_start[c + 1])
+	std::vector<Entry> cells;
+	std::vector<Entry> large;
+	std::vector<int> fill;
+	std::vector<double> radii;
+
+	// Clamped before the cast, so points far outside the grid cannot overflow the int
+	[[nodiscard]] int column(double x) const { return static_cast<int>(std::clamp(std::floor((x - min_x) / cell_size), 0.0, static_cast<double>(cols - 1))); }
+	[[nodiscard]] int row(double y) const { return static_cast<int>(std::clamp(std::floor((y - min_y) / cell_size), 0.0, static_cast<double>(rows - 1))); }
+
+	template <typename Fn>
+	void forEachInBox(double x0, double y0, double x1, double y1, Fn&& fn) const;
+};
+
+template <typename Fn>
+void SpatialIndex::forEachInBox(double x0, double y0, double x1, double y1, Fn&& fn) const
+{
+	for (const Entry& e : large)
+		fn(e);
+	if (cells.empty())
+		return;
+
+	// Small discs can reach up to max_small_radius out of their cell
+	const int c0 = column(x0 - max_small_radius), c1 = column(x1 + max_small_radius);
+	const int r0 = row(y0 - max_small_radius), r1 = row(y1 + max_small_radius);
+	for (int r = r0; r <= r1; ++r)
+	{
+		const int first = cell_start[r * cols + c0];
+		const int last = cell_start[r * cols + c1 + 1];
+		for (int k = first; k < last; ++k)
+			fn(cells[k]);
+	}
+}
+
+template <typename Fn>
+void SpatialIndex::queryCircle(double x, double y, double radius, Fn&& fn) const
+{
+	forEachInBox(x - radius, y - radius, x + radius, y + radius, [&](const Entry& e) {
+		const double dx = e.x - x;
+		const double dy = e.y - y;
+		const double range = radius + e.radius;
+		if (dx * dx + dy * dy <= range * range)
+			fn(e);
+	});
+}
+
+template <typename Fn>
+void SpatialIndex::querySegment(double ax, double ay, double bx, double by, double radius, Fn&& fn) const
+{
+	const double sx = bx - ax;
+	const double sy = by - ay;
+	const double length_sq = sx * sx + sy * sy;
+
+	forEachInBox(std::min(ax, bx) - radius, std::min(ay, by) - radius, std::max(ax, bx) + radius, std::max(ay, by) + radius,
+		[&](const Entry& e) {
+			// Closest point of the segment to the centre
+			const double t = length_sq > 0.0 ? std::clamp(((e.x - ax) * sx + (e.y - ay) * sy) / length_sq, 0.0, 1.0) : 0.0;
+			const double dx = e.x - (ax + t * sx);
+			const double dy = e.y - (ay + t * sy);
+			const double range = radius + e.radius;
+			if (dx * dx + dy * dy <= range * range)
+				fn(e);
+		});
+}
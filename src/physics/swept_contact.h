@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <vector>
+
+#include "body_store.h"
+#include "../physics_utils.h"
+
+/*
+ * Continuous collision and Roche checks for the force passes in Space::update().
+ *
+ * Each body's path since the start of the tick is the cubic Hermite curve through its starting position
+ * and velocity (store.step_*) and its current ones, cut into SEGMENTS straight pieces. Two bodies meet
+ * when their relative path enters the contact range, so bodies that cross each other within a tick are
+ * still caught at large timesteps. Following curves rather than chords keeps tight orbits from being
+ * cut short across the attracting body.
+ */
+class SweptPaths
+{
+public:
+	static constexpr int SEGMENTS = 4;
+
+	/*
+	 * Samples the paths of all bodies over the `elapsed` time since the start of the tick.
+	 */
+	void build(const BodyStore& s, double elapsed)
+	{
+		resize(s.size());
+		for (int k = 0; k < s.size(); ++k)
+			sample(s, elapsed, k);
+	}
+
+	/*
+	 * Samples the paths of the given slots only, for passes whose event checks see no other bodies.
+	 * The other slots keep the paths of an earlier build.
+	 */
+	void build(const BodyStore& s, double elapsed, std::span<const int> slots)
+	{
+		resize(s.size());
+		for (const int k : slots)
+			sample(s, elapsed, k);
+	}
+
+	/*
+	 * Farthest the body's path has been from its current position, the widening of its contact reach.
+	 */
+	[[nodiscard]] double reachExtension(int k) const { return extent[k]; }
+
+	/*
+	 * Earliest fraction of the elapsed time at which bodies i and j are closer than `range`, or -1 if they
+	 * never are.
+	 */
+	[[nodiscard]] double timeOfImpact(int i, int j, double range) const
+	{
+		const double* ix = &x[static_cast<size_t>(i) * (SEGMENTS + 1)];
+		const double* iy = &y[static_cast<size_t>(i) * (SEGMENTS + 1)];
+		const double* jx = &x[static_cast<size_t>(j) * (SEGMENTS + 1)];
+		const double* jy = &y[static_cast<size_t>(j) * (SEGMENTS + 1)];
+		for (int m = 0; m < SEGMENTS; ++m)
+		{
+			const double t = PhysicsUtils::segmentEntersCircle(jx[m] - ix[m], jy[m] - iy[m],
+				jx[m + 1] - ix[m + 1], jy[m + 1] - iy[m + 1], range);
+			if (t >= 0.0)
+				return (m + t) / SEGMENTS;
+		}
+		return -1.0;
+	}
+
+private:
+	std::vector<double> x, y;	// SEGMENTS + 1 points per slot
+	std::vector<double> extent;
+
+	void resize(int n)
+	{
+		x.resize(static_cast<size_t>(n) * (SEGMENTS + 1));
+		y.resize(x.size());
+		extent.resize(n);
+	}
+
+	void sample(const BodyStore& s, double elapsed, int k)
+	{
+		double* px = &x[static_cast<size_t>(k) * (SEGMENTS + 1)];
+		double* py = &y[static_cast<size_t>(k) * (SEGMENTS + 1)];
+		extent[k] = 0.0;
+		for (int m = 0; m <= SEGMENTS; ++m)
+		{
+			// Hermite basis on u in [0, 1], tangents scaled to the elapsed time
+			const double u = static_cast<double>(m) / SEGMENTS;
+			const double h00 = (1.0 + 2.0 * u) * (1.0 - u) * (1.0 - u);
+			const double h10 = u * (1.0 - u) * (1.0 - u);
+			const double h01 = u * u * (3.0 - 2.0 * u);
+			const double h11 = u * u * (u - 1.0);
+			px[m] = h00 * s.step_x[k] + h10 * elapsed * s.step_vx[k] + h01 * s.x[k] + h11 * elapsed * s.vx[k];
+			py[m] = h00 * s.step_y[k] + h10 * elapsed * s.step_vy[k] + h01 * s.y[k] + h11 * elapsed * s.vy[k];
+			extent[k] = std::max(extent[k], std::hypot(px[m] - s.x[k], py[m] - s.y[k]));
+		}
+	}
+};
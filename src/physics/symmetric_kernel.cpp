@@ -0,0 +1,285 @@
+#include "symmetric_kernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simd_lanes.h"
+#include "../task_pool.h"
+
+namespace {
+
+// Lexicographic (largest force, then lowest slot) update, so the result does not depend on pair order
+inline void keepStrongest(double force, double slot, double& max_force, double& max_slot)
+{
+	if (force > max_force || (force == max_force && force > 0.0 && slot < max_slot))
+	{
+		max_force = force;
+		max_slot = slot;
+	}
+}
+
+}
+
+void SymmetricPairKernel::Accumulators::reset(int n)
+{
+	ax.assign(n, 0.0);
+	ay.assign(n, 0.0);
+	heat.assign(n, 0.0);
+	max_force.assign(n, 0.0);
+	max_slot.assign(n, -1.0);
+	contact.assign(n, 0.0);
+}
+
+void SymmetricPairKernel::Accumulators::mergeFrom(const Accumulators& other, int begin, int end)
+{
+	for (int k = begin; k < end; ++k)
+	{
+		ax[k] += other.ax[k];
+		ay[k] += other.ay[k];
+		heat[k] += other.heat[k];
+		contact[k] = std::max(contact[k], other.contact[k]);
+		if (other.max_slot[k] >= 0.0)
+			keepStrongest(other.max_force[k], other.max_slot[k], max_force[k], max_slot[k]);
+	}
+}
+
+template <bool Gravity, bool Heat>
+void SymmetricPairKernel::accumulatePairs(const BodyStore& store, int i, int j_begin, int j_end, Accumulators& acc)
+{
+	using L = SimdLanes;
+
+	const double xi = store.x[i];
+	const double yi = store.y[i];
+	const double gi = store.g_mass[i];
+	const double hi = store.heat[i];
+	const double reach_i = store.reach[i];
+	const double slot_i = static_cast<double>(i);
+
+	const double* px = store.x.data();
+	const double* py = store.y.data();
+	const double* pg = store.g_mass.data();
+	const double* ph = store.heat.data();
+	const double* pr = store.reach.data();
+	double* acc_ax = acc.ax.data();
+	double* acc_ay = acc.ay.data();
+	double* acc_heat = acc.heat.data();
+	double* acc_force = acc.max_force.data();
+	double* acc_slot = acc.max_slot.data();
+	double* acc_contact = acc.contact.data();
+
+	// Body i is kept in registers, the j side is read-modify-written in the accumulators
+	const L::V vxi = L::set(xi), vyi = L::set(yi), vgi = L::set(gi), vhi = L::set(hi);
+	const L::V vreach_i = L::set(reach_i), vslot_i = L::set(slot_i);
+	const L::V min_d2 = L::set(0.01), one = L::set(1.0);
+
+	L::V ax = L::set(0.0), ay = L::set(0.0), heat = L::set(0.0);
+	L::V max_force = L::set(0.0), max_slot = L::set(-1.0);
+	L::M contact = L::none();
+
+	int j = j_begin;
+	for (; j + L::WIDTH <= j_end; j += L::WIDTH)
+	{
+		const L::V dx = L::sub(L::load(px + j), vxi);
+		const L::V dy = L::sub(L::load(py + j), vyi);
+		const L::V d2 = L::max(L::fma(dx, dx, L::mul(dy, dy)), min_d2);
+
+		const L::V contact_range = L::add(vreach_i, L::load(pr + j));
+		const L::M touching = L::less(d2, L::mul(contact_range, contact_range));
+		contact = L::either(contact, touching);
+		if (L::any(touching))
+			L::store(acc_contact + j, L::select(touching, one, L::load(acc_contact + j)));
+
+		if constexpr (Gravity || Heat)
+		{
+			const L::V inv_d = L::div(one, L::sqrt(d2));
+
+			if constexpr (Gravity)
+			{
+				const L::V inv_d2 = L::mul(inv_d, inv_d);
+
+				// Pull of j on i
+				const L::V force_i = L::mul(L::load(pg + j), inv_d2);
+				const L::V factor_i = L::mul(force_i, inv_d);
+				ax = L::fma(factor_i, dx, ax);
+				ay = L::fma(factor_i, dy, ay);
+				const L::M stronger_i = L::greater(force_i, max_force);
+				max_force = L::select(stronger_i, force_i, max_force);
+				max_slot = L::select(stronger_i, L::iota(static_cast<double>(j)), max_slot);
+
+				// Pull of i on j, in the opposite direction
+				const L::V force_j = L::mul(vgi, inv_d2);
+				const L::V factor_j = L::mul(force_j, inv_d);
+				L::store(acc_ax + j, L::sub(L::load(acc_ax + j), L::mul(factor_j, dx)));
+				L::store(acc_ay + j, L::sub(L::load(acc_ay + j), L::mul(factor_j, dy)));
+
+				// Attractor updates on the j side are rare once a few tiles are in, so skip the stores
+				const L::V force_j_max = L::load(acc_force + j);
+				const L::V slot_j_max = L::load(acc_slot + j);
+				const L::M stronger_j = L::either(L::greater(force_j, force_j_max),
+					L::both(L::equal(force_j, force_j_max), L::less(vslot_i, slot_j_max)));
+				if (L::any(stronger_j))
+				{
+					L::store(acc_force + j, L::select(stronger_j, force_j, force_j_max));
+					L::store(acc_slot + j, L::select(stronger_j, vslot_i, slot_j_max));
+				}
+			}
+
+			if constexpr (Heat)
+			{
+				const L::V heat_falloff = L::min(inv_d, one);
+				heat = L::fma(L::load(ph + j), heat_falloff, heat);
+				L::store(acc_heat + j, L::fma(vhi, heat_falloff, L::load(acc_heat + j)));
+			}
+		}
+	}
+
+	for (; j < j_end; ++j)
+	{
+		const double dx = px[j] - xi;
+		const double dy = py[j] - yi;
+		const double d2 = std::max(dx * dx + dy * dy, 0.01);
+		const double contact_range = reach_i + pr[j];
+		if (d2 < contact_range * contact_range)
+		{
+			acc_contact[i] = 1.0;
+			acc_contact[j] = 1.0;
+		}
+
+		if constexpr (Gravity || Heat)
+		{
+			const double inv_d = 1.0 / std::sqrt(d2);
+
+			if constexpr (Gravity)
+			{
+				const double inv_d2 = inv_d * inv_d;
+				const double force_i = pg[j] * inv_d2;
+				acc_ax[i] += force_i * inv_d * dx;
+				acc_ay[i] += force_i * inv_d * dy;
+				keepStrongest(force_i, static_cast<double>(j), acc_force[i], acc_slot[i]);
+
+				const double force_j = gi * inv_d2;
+				acc_ax[j] -= force_j * inv_d * dx;
+				acc_ay[j] -= force_j * inv_d * dy;
+				keepStrongest(force_j, slot_i, acc_force[j], acc_slot[j]);
+			}
+
+			if constexpr (Heat)
+			{
+				const double heat_falloff = std::min(inv_d, 1.0);
+				acc_heat[i] += ph[j] * heat_falloff;
+				acc_heat[j] += hi * heat_falloff;
+			}
+		}
+	}
+
+	// Fold the lanes of body i into its accumulator
+	alignas(64) double lane_ax[L::WIDTH], lane_ay[L::WIDTH], lane_heat[L::WIDTH], lane_force[L::WIDTH], lane_slot[L::WIDTH];
+	L::store(lane_ax, ax);
+	L::store(lane_ay, ay);
+	L::store(lane_heat, heat);
+	L::store(lane_force, max_force);
+	L::store(lane_slot, max_slot);
+	for (int l = 0; l < L::WIDTH; ++l)
+	{
+		acc_ax[i] += lane_ax[l];
+		acc_ay[i] += lane_ay[l];
+		acc_heat[i] += lane_heat[l];
+		if (lane_slot[l] >= 0.0)
+			keepStrongest(lane_force[l], lane_slot[l], acc_force[i], acc_slot[i]);
+	}
+	if (L::any(contact))
+		acc_contact[i] = 1.0;
+}
+
+bool SymmetricPairKernel::balances(int n_active, int threads) noexcept
+{
+	const int n_tiles = (n_active + TILE - 1) / TILE;
+	return threads <= 1 || n_tiles * (n_tiles + 1) / 2 >= MIN_PAIRS_PER_THREAD * threads;
+}
+
+void SymmetricPairKernel::accumulate(const BodyStore& store, std::vector<PairKernel::Sums>& out, PairKernel::Terms terms)
+{
+	const int n = store.size();
+	const int n_active = store.sources();
+	out.resize(n);
+	if (n == 0)
+		return;
+
+	// Pair loop for the terms of this pass, indexed by Terms::index()
+	using PairsFn = void (*)(const BodyStore&, int, int, int, Accumulators&);
+	static constexpr PairsFn pair_loops[] = {
+		&accumulatePairs<false, false>, &accumulatePairs<false, true>,
+		&accumulatePairs<true, false>, &accumulatePairs<true, true>
+	};
+	const PairsFn accumulate_pairs = pair_loops[terms.index()];
+
+	// Pairs among the active bodies, passive ones only receive and are summed one way after them
+	const int n_tiles = (n_active + TILE - 1) / TILE;
+	tile_pairs.clear();
+	for (int a = 0; a < n_tiles; ++a)
+		for (int b = a; b < n_tiles; ++b)
+			tile_pairs.emplace_back(a, b);
+	const int n_pairs = static_cast<int>(tile_pairs.size());
+
+	// Tile pairs are dealt cyclically to a fixed number of groups, each summed by one task into its own
+	// accumulators. The result then depends on the thread count only, not on which thread ran a group.
+	TaskPool& pool = TaskPool::global();
+	const int n_groups = n_active > TILE ? std::clamp(pool.threadCount(), 1, n_pairs) : 1;
+	if (static_cast<int>(per_group.size()) < n_groups)
+		per_group.resize(n_groups);
+
+	pool.parallelFor(0, n_groups, 1, [&](int group) {
+		Accumulators& acc = per_group[group];
+		acc.reset(n_active);
+
+		// Each group only writes its own accumulators, on both sides of every pair it owns
+		for (int p = group; p < n_pairs; p += n_groups)
+		{
+			const int i_tile = tile_pairs[p].first;
+			const int j_tile = tile_pairs[p].second;
+			const int i_end = std::min((i_tile + 1) * TILE, n_active);
+			const int j_end = std::min((j_tile + 1) * TILE, n_active);
+
+			for (int i = i_tile * TILE; i < i_end; ++i)
+			{
+				const int j_begin = (i_tile == j_tile) ? i + 1 : j_tile * TILE;
+				accumulate_pairs(store, i, j_begin, j_end, acc);
+			}
+		}
+	});
+
+	// Tree reduction: at each level group g absorbs group g + stride, chunked over bodies, so the merge takes
+	// log2(groups) parallel rounds. The pairing depends on the group count only.
+	const int n_chunks = (n_active + MERGE_CHUNK - 1) / MERGE_CHUNK;
+	for (int stride = 1; stride < n_groups; stride *= 2)
+	{
+		const int n_targets = (n_groups + 2 * stride - 1) / (2 * stride);
+		pool.parallelFor(0, n_targets * n_chunks, 1, [&](int k) {
+			const int target = (k / n_chunks) * 2 * stride;
+			const int source = target + stride;
+			if (source >= n_groups) return;
+			const int begin = (k % n_chunks) * MERGE_CHUNK;
+			per_group[target].mergeFrom(per_group[source], begin, std::min(begin + MERGE_CHUNK, n_active));
+		});
+	}
+
+	const Accumulators& total = per_group[0];
+	pool.parallelFor(0, n_chunks, 1, [&](int chunk) {
+		const int begin = chunk * MERGE_CHUNK;
+		const int end = std::min(begin + MERGE_CHUNK, n_active);
+		for (int k = begin; k < end; ++k)
+		{
+			PairKernel::Sums& sums = out[k];
+			sums.ax = total.ax[k];
+			sums.ay = total.ay[k];
+			sums.heat = total.heat[k];
+			sums.max_force = total.max_force[k];
+			sums.max_slot = static_cast<int>(total.max_slot[k]);
+			sums.contact = total.contact[k] > 0.0;
+		}
+	});
+
+	pool.parallelChunks(n_active, n, PASSIVE_BLOCK, [&](int begin, int end) {
+		PairKernel::accumulate(store, begin, end, out.data() + begin, terms);
+	});
+}
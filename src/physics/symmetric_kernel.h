@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+
+#include "pair_kernel.h"
+
+/*
+ * Direct sum that evaluates every pair once and applies it to both bodies (Newton's third law).
+ *
+ * Bodies are split into tiles and the upper triangle of tile pairs is dealt cyclically to one group per
+ * thread of the TaskPool. Each group adds into its own accumulators, which are kept between ticks, and
+ * the groups are merged by a pairwise tree reduction, chunk by chunk in parallel, instead of in a critical
+ * section. Up to one tile of active bodies runs as a single group on the calling thread.
+ * The groups cannot be balanced finer than whole tile pairs, so on several threads the kernel only pays off
+ * with a few tile pairs per thread, see balances().
+ * The output matches PairKernel::accumulate, including the lowest slot winning strongest-attractor ties,
+ * and the pair loop is instantiated per PairKernel::Terms in the same way. Only active bodies pair up,
+ * passive ones take the one-way kernel over the active slots.
+ */
+class SymmetricPairKernel
+{
+public:
+	void accumulate(const BodyStore& store, std::vector<PairKernel::Sums>& out, PairKernel::Terms terms = {});
+
+	/*
+	 * Whether n_active bodies give `threads` threads enough tile pairs to share: always on one thread, else
+	 * MIN_PAIRS_PER_THREAD per thread. Below that the one-sided kernel, which splits the bodies, is faster.
+	 */
+	[[nodiscard]] static bool balances(int n_active, int threads) noexcept;
+
+	static constexpr int MIN_PAIRS_PER_THREAD = 3;
+
+private:
+	static constexpr int TILE = 256;
+	static constexpr int MERGE_CHUNK = 1024;
+	static constexpr int PASSIVE_BLOCK = 16;
+
+	struct Accumulators
+	{
+		std::vector<double> ax, ay, heat;
+		std::vector<double> max_force, max_slot;
+		std::vector<double> contact;	// 1.0 once a body within reach has been seen
+
+		void reset(int n);
+		void mergeFrom(const Accumulators& other, int begin, int end);
+	};
+
+	std::vector<Accumulators> per_group;
+	std::vector<std::pair<int, int>> tile_pairs;
+
+	template <bool Gravity, bool Heat>
+	static void accumulatePairs(const BodyStore& store, int i, int j_begin, int j_end, Accumulators& acc);
+};
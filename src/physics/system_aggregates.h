@@ -0,0 +1,60 @@
+#pragma once
+
+/*
+ * Totals over the bodies of the system: mass, centre of mass, linear and angular momentum, kinetic and
+ * potential energy, each O(1) to read.
+ *
+ * The moments are kept as plain sums, so a body that enters or leaves only adds or takes away its own
+ * terms. The physics step rebuilds them once per tick from the end-of-tick state, so rounding, and edits
+ * that go around add() and remove() (dragging a planet, the ship's tug), last at most one tick.
+ *
+ * The potential energy is the virial of the last force pass, sum of m_i * (r_i - c) . a_i over the bodies
+ * that source gravity. For Newtonian pairs this equals the sum of -G m_i m_j / r_ij exactly, and any
+ * point c gives the same sum when the pulls balance. Passive bodies pull on nothing and carry no potential
+ * energy. Bodies that entered or left since the last force pass do not change it.
+ */
+struct SystemAggregates
+{
+	double mass{ 0.0 };
+	double mass_x{ 0.0 }, mass_y{ 0.0 };			// sum of m * position
+	double momentum_x{ 0.0 }, momentum_y{ 0.0 };
+	double angular_momentum{ 0.0 };					// sum of m * (x * vy - y * vx), about the origin
+	double kinetic{ 0.0 };
+	double potential{ 0.0 };
+
+	void add(double m, double x, double y, double vx, double vy, double sign = 1.0) noexcept
+	{
+		const double sm = sign * m;
+		mass += sm;
+		mass_x += sm * x;
+		mass_y += sm * y;
+		momentum_x += sm * vx;
+		momentum_y += sm * vy;
+		angular_momentum += sm * (x * vy - y * vx);
+		kinetic += 0.5 * sm * (vx * vx + vy * vy);
+	}
+
+	void remove(double m, double x, double y, double vx, double vy) noexcept { add(m, x, y, vx, vy, -1.0); }
+
+	// Same for anything with getMass(), getPosition() and getVelocity()
+	template <typename Body>
+	void add(const Body& body, double sign = 1.0) noexcept
+	{
+		const auto pos = body.getPosition();
+		const auto vel = body.getVelocity();
+		add(body.getMass(), pos.x, pos.y, vel.x, vel.y, sign);
+	}
+
+	template <typename Body>
+	void remove(const Body& body) noexcept { add(body, -1.0); }
+
+	[[nodiscard]] double centerX() const noexcept { return mass > 0.0 ? mass_x / mass : 0.0; }
+	[[nodiscard]] double centerY() const noexcept { return mass > 0.0 ? mass_y / mass : 0.0; }
+	[[nodiscard]] double velocityX() const noexcept { return mass > 0.0 ? momentum_x / mass : 0.0; }
+	[[nodiscard]] double velocityY() const noexcept { return mass > 0.0 ? momentum_y / mass : 0.0; }
+
+	// Angular momentum about the centre of mass, which does not change with the frame's origin
+	[[nodiscard]] double spin() const noexcept { return angular_momentum - (centerX() * momentum_y - centerY() * momentum_x); }
+
+	[[nodiscard]] double energy() const noexcept { return kinetic + potential; }
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+
+#include "../task_pool.h"
+
+/*
+ * One append-only buffer per thread of the TaskPool, for results that parallel loops produce rarely and in
+ * no particular order (collision and Roche events).
+ *
+ * Each thread appends to its own buffer, so no lock is taken, and the buffers sit on separate cache
+ * lines. gather() concatenates them once the parallel work is done. The order of the result depends
+ * on the threads, so callers sort it. Storage is kept between ticks.
+ */
+template <typename T>
+class ThreadBuffers
+{
+public:
+	// Empties the buffers and makes room for every thread of the pool
+	void reset()
+	{
+		const int threads = TaskPool::global().threadCount();
+		if (static_cast<int>(buffers.size()) < threads)
+			buffers.resize(threads);
+		for (Buffer& buffer : buffers)
+			buffer.items.clear();
+	}
+
+	// Buffer of the calling thread, inside or outside a parallel loop
+	std::vector<T>& local()
+	{
+		return buffers[TaskPool::workerIndex()].items;
+	}
+
+	void gather(std::vector<T>& out) const
+	{
+		out.clear();
+		for (const Buffer& buffer : buffers)
+			out.insert(out.end(), buffer.items.begin(), buffer.items.end());
+	}
+
+private:
+	struct alignas(64) Buffer
+	{
+		std::vector<T> items;
+	};
+
+	std::vector<Buffer> buffers;
+};
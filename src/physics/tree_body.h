@@ -0,0 +1,21 @@
+#pragma once
+
+/*
+ * Input and output types shared by the hierarchical gravity solvers.
+ */
+
+struct TreeBody
+{
+	double x, y;
+	double g_mass;
+	double reach;		// furthest distance at which this body can collide or trigger a Roche breakup, 0 if the caller checks contacts on its own
+	int index;			// index into the caller's body arrays
+};
+
+struct FarField
+{
+	double ax{ 0.0 };
+	double ay{ 0.0 };
+	double max_force{ 0.0 };	// strongest single attractor among the approximated bodies
+	int max_index{ -1 };
+};
@@ -0,0 +1,166 @@
+#include "wisdom_holman.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Stumpff functions c0..c3 of z = beta * s^2, with series near zero where the closed forms cancel
+void stumpff(double z, double& c0, double& c1, double& c2, double& c3)
+{
+	if (z > 1e-3)
+	{
+		const double sz = std::sqrt(z);
+		c0 = std::cos(sz);
+		c1 = std::sin(sz) / sz;
+		c2 = (1.0 - c0) / z;
+		c3 = (1.0 - c1) / z;
+	}
+	else if (z < -1e-3)
+	{
+		const double sz = std::sqrt(-z);
+		c0 = std::cosh(sz);
+		c1 = std::sinh(sz) / sz;
+		c2 = (1.0 - c0) / z;
+		c3 = (1.0 - c1) / z;
+	}
+	else
+	{
+		c3 = 1.0 / 6.0 - z * (1.0 / 120.0 - z * (1.0 / 5040.0 - z / 362880.0));
+		c2 = 0.5 - z * (1.0 / 24.0 - z * (1.0 / 720.0 - z / 40320.0));
+		c1 = 1.0 - z * c3;
+		c0 = 1.0 - z * c2;
+	}
+}
+
+}
+
+namespace WisdomHolman
+{
+	int dominantBody(const BodyStore& store)
+	{
+		const int n = store.size();
+		if (n < 2)
+			return -1;
+
+		const auto heaviest = std::max_element(store.mass.begin(), store.mass.end());
+		double others = 0.0;
+		for (const double m : store.mass)
+			others += m;
+		others -= *heaviest;
+
+		if (*heaviest < MIN_MASS_RATIO * others)
+			return -1;
+		return static_cast<int>(heaviest - store.mass.begin());
+	}
+
+	bool hasCloseEncounter(const BodyStore& store, int central, double dt, std::pmr::memory_resource* scratch)
+	{
+		const int n = store.size();
+		const double m0 = store.mass[central];
+
+		// Sweep over the distance from the central body, a pair can only be as close as its bodies' distances differ
+		std::pmr::vector<std::pair<double, int>> by_distance(scratch);
+		by_distance.reserve(n);
+		double max_mass = 0.0, max_speed = 0.0;
+		for (int k = 0; k < n; ++k)
+		{
+			if (k == central) continue;
+			by_distance.emplace_back(std::hypot(store.x[k] - store.x[central], store.y[k] - store.y[central]), k);
+			max_mass = std::max(max_mass, store.mass[k]);
+			max_speed = std::max(max_speed, std::hypot(store.vx[k], store.vy[k]));
+		}
+		std::sort(by_distance.begin(), by_distance.end());
+
+		const int n_others = static_cast<int>(by_distance.size());
+		for (int a = 0; a < n_others; ++a)
+		{
+			const auto [r_i, i] = by_distance[a];
+
+			// Largest distance a partner can have and still be in reach: r_j - r_i < K h (r_i + r_j) / 2 + 2 v dt
+			const double widest = ENCOUNTER_HILL_RADII * std::cbrt((store.mass[i] + max_mass) / (3.0 * m0)) / 2.0;
+			const double r_limit = widest < 1.0
+				? (r_i * (1.0 + widest) + 2.0 * max_speed * dt) / (1.0 - widest)
+				: std::numeric_limits<double>::infinity();
+
+			for (int b = a + 1; b < n_others && by_distance[b].first < r_limit; ++b)
+			{
+				const auto [r_j, j] = by_distance[b];
+				const double hill = std::cbrt((store.mass[i] + store.mass[j]) / (3.0 * m0)) * 0.5 * (r_i + r_j);
+
+				// Closest approach within the tick, moving in straight lines
+				const double dx = store.x[j] - store.x[i];
+				const double dy = store.y[j] - store.y[i];
+				const double dvx = store.vx[j] - store.vx[i];
+				const double dvy = store.vy[j] - store.vy[i];
+				const double dv2 = dvx * dvx + dvy * dvy;
+				const double t = dv2 > 0.0 ? std::clamp(-(dx * dvx + dy * dvy) / dv2, 0.0, dt) : 0.0;
+				const double closest = std::hypot(dx + dvx * t, dy + dvy * t);
+
+				if (closest < ENCOUNTER_HILL_RADII * hill)
+					return true;
+			}
+		}
+		return false;
+	}
+
+	void keplerDrift(double mu, double& x, double& y, double& vx, double& vy, double dt)
+	{
+		const double r0 = std::hypot(x, y);
+		if (r0 <= 0.0 || mu <= 0.0)
+		{
+			x += vx * dt;
+			y += vy * dt;
+			return;
+		}
+
+		const double eta0 = x * vx + y * vy;
+		const double beta = 2.0 * mu / r0 - (vx * vx + vy * vy);	// > 0 on bound orbits
+		const double zeta0 = mu - beta * r0;
+
+		// Whole periods of a bound orbit bring the body back where it started
+		double t = dt;
+		if (beta > 0.0)
+		{
+			const double period = 2.0 * std::numbers::pi * mu / (beta * std::sqrt(beta));
+			t = std::fmod(dt, period);
+		}
+
+		// Solve r0 s + eta0 G2 + zeta0 G3 = t for the universal anomaly s, with Laguerre-Conway iterations
+		constexpr double ORDER = 5.0;
+		double s = t / r0;
+		double c0 = 1.0, c1 = 1.0, c2 = 0.5, c3 = 1.0 / 6.0;
+		for (int iteration = 0; iteration < 50; ++iteration)
+		{
+			stumpff(beta * s * s, c0, c1, c2, c3);
+			const double g1 = s * c1, g2 = s * s * c2, g3 = s * s * s * c3;
+			const double f = r0 * s + eta0 * g2 + zeta0 * g3 - t;
+			const double df = r0 + eta0 * g1 + zeta0 * g2;
+			const double ddf = eta0 * c0 + zeta0 * g1;
+			const double root = std::sqrt(std::abs((ORDER - 1.0) * (ORDER - 1.0) * df * df - ORDER * (ORDER - 1.0) * f * ddf));
+			const double ds = -ORDER * f / (df + (df >= 0.0 ? root : -root));
+			s += ds;
+			if (std::abs(ds) <= 1e-14 * std::abs(s))
+				break;
+		}
+		stumpff(beta * s * s, c0, c1, c2, c3);
+		const double g1 = s * c1, g2 = s * s * c2;
+		const double r = r0 + eta0 * g1 + zeta0 * g2;
+
+		// Gauss f and g functions
+		const double f = 1.0 - mu * g2 / r0;
+		const double g = r0 * g1 + eta0 * g2;
+		const double fd = -mu * g1 / (r * r0);
+		const double gd = 1.0 - mu * g2 / r;
+
+		const double x0 = x, y0 = y, vx0 = vx, vy0 = vy;
+		x = f * x0 + g * vx0;
+		y = f * y0 + g * vy0;
+		vx = fd * x0 + gd * vx0;
+		vy = fd * y0 + gd * vy0;
+	}
+}
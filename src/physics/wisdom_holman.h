@@ -0,0 +1,41 @@
+#pragma once
+
+#include <memory_resource>
+
+#include "body_store.h"
+
+/*
+ * Pieces of the Wisdom-Holman step in Space::update(), for systems dominated by one central body.
+ *
+ * The other bodies are integrated in democratic heliocentric variables: positions relative to the
+ * central body and velocities relative to the barycentre. Their motion around the central body is
+ * solved exactly as a Kepler orbit, so the timestep only has to resolve the much weaker pulls between
+ * them. The step does not hold up once two of them pass close to each other, which
+ * hasCloseEncounter() detects so the caller can use the leapfrog for that tick instead.
+ */
+namespace WisdomHolman
+{
+	// The central body has to outweigh all others together by this factor
+	inline constexpr double MIN_MASS_RATIO = 5.0;
+
+	// Pairs closer than this many mutual Hill radii count as a close encounter
+	inline constexpr double ENCOUNTER_HILL_RADII = 3.0;
+
+	/*
+	 * Slot of the body dominating the store's mass, or -1 if there is none.
+	 */
+	int dominantBody(const BodyStore& store);
+
+	/*
+	 * True if two bodies other than `central` are, or can get within `dt`, closer than
+	 * ENCOUNTER_HILL_RADII mutual Hill radii. The sweep's working array comes from `scratch`.
+	 */
+	bool hasCloseEncounter(const BodyStore& store, int central, double dt, std::pmr::memory_resource* scratch);
+
+	/*
+	 * Advances a relative position and velocity along the Kepler orbit around a mass with
+	 * gravitational parameter `mu` (G * m) by `dt`. Works for bound and unbound orbits alike
+	 * (universal variables).
+	 */
+	void keplerDrift(double mu, double& x, double& y, double& vx, double& vy, double dt);
+}
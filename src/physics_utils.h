@@ -104,4 +104,24 @@ inline bool segmentIntersectsCircle(sf::Vector2f start, sf::Vector2f end, sf::Ve
     return false;
 }
 
+// Fraction along the segment from start to end at which it first comes within radius of the origin:
+// 0 if it starts inside, -1 if it never does. Double precision variant of segmentIntersectsCircle for relative paths.
+inline double segmentEntersCircle(double start_x, double start_y, double end_x, double end_y, double radius)
+{
+    const double c = start_x*start_x + start_y*start_y - radius*radius;
+    if (c < 0.0) return 0.0;
+
+    const double dx = end_x - start_x;
+    const double dy = end_y - start_y;
+    const double a = dx*dx + dy*dy;
+    const double b = 2*(start_x*dx + start_y*dy);
+    if (a <= 0.0 || b >= 0.0) return -1.0;     // not moving, or moving away
+
+    const double discriminant = b*b - 4*a*c;
+    if (discriminant < 0.0) return -1.0;
+
+    const double t = (-b - std::sqrt(discriminant))/(2*a);
+    return t <= 1.0 ? t : -1.0;
+}
+
 }
@@ -90,6 +90,8 @@ void Space::runSim(sf::Vector2i window_size, bool fullscreen, int udp_port)
 	sf::Event event;
 	while (window.isOpen())
 	{
+		// Paused frames draw without a tick, so the frame resets the scratch as well
+		frame_arena.reset();
 		timestep = config.paused ? 0.0 : timeStepSlider->getValue();
 
 		// Check if mouse is inside the window bounds
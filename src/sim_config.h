@@ -2,6 +2,27 @@
 
 #include "CONSTANTS.h"
 
+enum class GravitySolver
+{
+    DIRECT,        // exact O(N^2) pair sum
+    BARNES_HUT,    // quadtree approximation of distant clusters, O(N log N)
+    FMM            // fast multipole expansions between distant cells, O(N)
+};
+
+enum class GravityPrecision
+{
+    DOUBLE,        // double precision pair sums
+    MIXED          // float pair terms, compensated sums, direct solver only
+};
+
+enum class Integrator
+{
+    LEAPFROG,      // second-order kick-drift-kick, one force pass per tick
+    YOSHIDA4,      // fourth-order symplectic composition of three leapfrog steps, three passes
+    HERMITE4,      // fourth-order predictor-corrector on acceleration and jerk, one pass plus a jerk sum
+    WISDOM_HOLMAN  // exact Kepler orbits around a dominant body plus kicks, leapfrog on close encounters
+};
+
 struct SimConfig
 {
     bool paused{ false };
@@ -13,4 +34,22 @@ struct SimConfig
     bool render_life_always{ false };
     float timestep_slider_value{ TIMESTEP_VALUE_START };
     double fuel_burn_rate{ 1.0 };
+    GravitySolver gravity_solver{ GravitySolver::DIRECT };
+    bool symmetric_pairs{ true };       // direct sum evaluates each pair once for both bodies, where there are enough tile pairs per thread
+    GravityPrecision gravity_precision{ GravityPrecision::DOUBLE };
+    Integrator integrator{ Integrator::LEAPFROG };   // block timesteps always step with the leapfrog
+    bool encounter_subcycling{ false }; // close pairs take their own substeps within a leapfrog tick
+    bool continuous_collisions{ true }; // collisions and Roche breakups along each body's path within a tick
+    double neighbour_skin{ 10.0 };      // margin of the collision neighbour lists, rebuilt once a body moves half of it
+    int reorder_interval{ 64 };         // ticks between checks of the space-filling-curve order of planets and dust, 0 disables
+    double reorder_disorder{ 0.2 };     // fraction of neighbours out of curve order above which a check sorts the array
+    double passive_mass{ 0.0 };         // bodies lighter than this feel gravity without sourcing it, 0 keeps all active
+    int worker_threads{ 0 };            // threads of the task pool, the main one included, 0 uses every hardware thread, at most 4x that
+    bool parallel_autotune{ true };     // loop schedules measured on this machine instead of the fixed defaults
+    bool block_timesteps{ false };      // per-body power-of-two substeps within a tick
+    int max_time_rung{ 6 };             // finest step is timestep / 2^max_time_rung
+    double time_rung_eta{ 0.1 };        // step as a fraction of the body's dynamical time
+    double barnes_hut_theta{ 0.5 };    // opening angle, 0 makes the tree exact
+    int fmm_order{ 4 };                 // expansion order, error drops roughly 4x per order
+    double fmm_theta{ 0.6 };            // (r_a + r_b) / dist below which cells interact by expansion
 };
@@ -45,7 +45,6 @@ CelestialBody::CelestialBody(double m, double xx, double yy, double xvv, double
 
 	randBrightness = modernRandomWithLimits(-30, +30);
 	updateRadiAndType();
-	circle.setPosition(position);
 
 	initializeFuel();
 	updateRadiAndType(); // recalculate with correct fuel fraction
@@ -57,7 +56,7 @@ CelestialBody::CelestialBody(double m, double xx, double yy, double xvv, double
 
 	//DETERMINING NUMBER OF ATMOSPHERE LINES, FOR GASGIANT PHASE
 	numAtmoLines = modernRandomWithLimits(minAtmoLayer, maxAtmoLayer);
-	for (int i = 0; i < numAtmoLines; i++) atmoLinesBrightness.push_back(
+	for (int i = 0; i < numAtmoLines; i++) atmoLinesBrightness[i] = static_cast<int8_t>(
 		modernRandomWithLimits(-brightnessVariance, brightnessVariance));
 }
 
@@ -121,11 +120,6 @@ std::string CelestialBody::getDisplayName() const noexcept
 	}
 }
 
-const std::string& CelestialBody::getName() const noexcept
-{
-	return name;
-}
-
 void CelestialBody::giveID(int i) noexcept
 {
 	id = i;
@@ -328,7 +322,7 @@ bool CelestialBody::canDisintegrate(double curr_time) const noexcept
 	if (!RocheLimit::hasMinimumBreakupSize(getMass()))
 		return false;
 
-	if (!ignore_ids.empty())
+	if (inFamily())
 		return false;
 
 	return true;
@@ -349,18 +343,6 @@ bool CelestialBody::disintegrationGraceTimeOver(double curr_time) const noexcept
 	return curr_time >= disintegrate_grace_end_time;
 }
 
-void CelestialBody::registerIgnoredId(int ignored_id)
-{
-	if (std::find(ignore_ids.begin(), ignore_ids.end(), ignored_id) == ignore_ids.end()) {
-		ignore_ids.push_back(ignored_id);
-	}
-}
-
-bool CelestialBody::isIgnoring(int check_id) const noexcept
-{
-	return std::find(ignore_ids.begin(), ignore_ids.end(), check_id) != ignore_ids.end();
-}
-
 void CelestialBody::becomeAbsorbedBy(CelestialBody& absorbing_planet)
 {
 	markForRemoval();
@@ -412,22 +394,22 @@ void CelestialBody::updateVisualProperties() noexcept
 	{
 	case ROCKY:
 		density = 0.5;
-		circle.setOutlineThickness(0);
-		circle.setPointCount(30);
+		appearance.outline_thickness = 0;
+		appearance.points = 30;
 		break;
 	case TERRESTRIAL:
 		density = 0.5;
-		circle.setPointCount(40);
+		appearance.points = 40;
 		break;
 	case GASGIANT:
 		density = 0.3;
-		circle.setPointCount(50);
+		appearance.points = 50;
 		break;
 	case BROWNDWARF:
 		density = DENSITY_BROWNDWARF;
-		circle.setOutlineColor(sf::Color(180, 80, 50, 60));
-		circle.setOutlineThickness(2);
-		circle.setPointCount(60);
+		appearance.outline = sf::Color(180, 80, 50, 60);
+		appearance.outline_thickness = 2;
+		appearance.points = 60;
 		break;
 	case STAR:
 		{
@@ -442,28 +424,28 @@ void CelestialBody::updateVisualProperties() noexcept
 			baseDensity = baseDensity + expansion * (giantDensity - baseDensity);
 		}
 		density = baseDensity;
-		circle.setPointCount(static_cast<int>(interpolate(90, 150, getMass(), GASGIANTLIMIT, STARLIMIT)));
-		circle.setOutlineThickness(static_cast<float>(interpolate(3, 10, getMass(), GASGIANTLIMIT, STARLIMIT)));
+		appearance.points = static_cast<int>(interpolate(90, 150, getMass(), GASGIANTLIMIT, STARLIMIT));
+		appearance.outline_thickness = static_cast<float>(interpolate(3, 10, getMass(), GASGIANTLIMIT, STARLIMIT));
 		break;
 		}
 	case WHITEDWARF:
 		density = DENSITY_WHITEDWARF;
-		circle.setOutlineColor(sf::Color(220, 220, 255, 40));
-		circle.setOutlineThickness(1);
-		circle.setPointCount(30);
+		appearance.outline = sf::Color(220, 220, 255, 40);
+		appearance.outline_thickness = 1;
+		appearance.points = 30;
 		break;
 	case NEUTRONSTAR:
 		density = DENSITY_NEUTRONSTAR;
-		circle.setOutlineColor(sf::Color(200, 200, 220, 40));
-		circle.setOutlineThickness(1);
-		circle.setPointCount(20);
+		appearance.outline = sf::Color(200, 200, 220, 40);
+		appearance.outline_thickness = 1;
+		appearance.points = 20;
 		break;
 	case BLACKHOLE:
 		density = INFINITY;
-		circle.setOutlineColor(sf::Color(255, 255, 255, 255));
-		circle.setFillColor(sf::Color(20, 20, 20));
-		circle.setOutlineThickness(2);
-		circle.setPointCount(20);
+		appearance.outline = sf::Color(255, 255, 255, 255);
+		appearance.fill = sf::Color(20, 20, 20);
+		appearance.outline_thickness = 2;
+		appearance.points = 20;
 		break;
 	}
 }
@@ -480,8 +462,6 @@ void CelestialBody::updateRadius() noexcept
 	{
 		radius = cbrt(getMass()) / density;
 	}
-	circle.setRadius(radius);
-	circle.setOrigin(radius, radius);
 }
 
 void CelestialBody::incMass(double m) noexcept
@@ -557,16 +537,17 @@ void CelestialBody::draw_thermal_shine(sf::RenderTarget& window) const
 
 void CelestialBody::draw_gas_planet_atmosphere(sf::RenderTarget& window) const
 {
-	for (size_t i = 0; i < atmoLinesBrightness.size(); i++)
+	const float disc_radius = static_cast<float>(radius);
+	for (int i = 0; i < numAtmoLines; i++)
 	{
 		sf::CircleShape atmoLine;
 
 		//SETTING FEATURES
 		int temp_lines = (numAtmoLines - 1);
 		atmoLine.setRadius(
-			circle.getRadius() - i * i * i * circle.getRadius() / (temp_lines * temp_lines * temp_lines));
+			disc_radius - i * i * i * disc_radius / (temp_lines * temp_lines * temp_lines));
 		atmoLine.setOrigin(atmoLine.getRadius(), atmoLine.getRadius());
-		atmoLine.setPosition(circle.getPosition());
+		atmoLine.setPosition(position);
 		atmoLine.setOutlineThickness(0);
 
 		//FINDING COLOR
@@ -641,16 +622,34 @@ void CelestialBody::draw_magnetar_glow(sf::RenderTarget& window) const
 	render_shine(window, position, coreCol, radius * 2.0);
 }
 
-void CelestialBody::render(sf::RenderTarget& window) const
+void CelestialBody::drawDisc(sf::RenderTarget& window, sf::Color fill, sf::Color outline) const
 {
-	circle.setPosition(position);
+	// One shape for all bodies, rendering happens on the main thread only. The geometry is only rebuilt
+	// when the radius or the point count differs from the last body drawn.
+	static sf::CircleShape disc;
+	const float r = static_cast<float>(radius);
+	if (disc.getRadius() != r)
+	{
+		disc.setRadius(r);
+		disc.setOrigin(r, r);
+	}
+	if (disc.getPointCount() != static_cast<size_t>(appearance.points))
+		disc.setPointCount(appearance.points);
+	disc.setOutlineThickness(appearance.outline_thickness);
+	disc.setFillColor(fill);
+	disc.setOutlineColor(outline);
+	disc.setPosition(position);
+	window.draw(disc);
+}
 
+void CelestialBody::render(sf::RenderTarget& window) const
+{
 	switch (getType())
 	{
 	case ROCKY:
 	case TERRESTRIAL:
 		draw_thermal_shine(window);
-		window.draw(circle);
+		drawDisc(window, appearance.fill, appearance.outline);
 		break;
 
 	case GASGIANT:
@@ -660,30 +659,25 @@ void CelestialBody::render(sf::RenderTarget& window) const
 
 	case BROWNDWARF:
 	case STAR:
-		window.draw(circle);
+		drawDisc(window, appearance.fill, appearance.outline);
 		draw_thermal_shine(window);
 		break;
 
 	case WHITEDWARF:
 		draw_thermal_shine(window);
-		window.draw(circle);
+		drawDisc(window, appearance.fill, appearance.outline);
 		break;
 
 	case NEUTRONSTAR:
 		draw_thermal_shine(window);
 		if (subType == PULSAR) draw_pulsar_beams(window);
 		if (subType == MAGNETAR) draw_magnetar_glow(window);
-		window.draw(circle);
+		drawDisc(window, appearance.fill, appearance.outline);
 		break;
 
 	case BLACKHOLE:
 		// Outline glow drawn here (gets bloomed); dark disc drawn separately after bloom
-		{
-			auto savedFill = circle.getFillColor();
-			circle.setFillColor(sf::Color::Transparent);
-			window.draw(circle);
-			circle.setFillColor(savedFill);
-		}
+		drawDisc(window, sf::Color::Transparent, appearance.outline);
 		break;
 	}
 }
@@ -691,11 +685,7 @@ void CelestialBody::render(sf::RenderTarget& window) const
 void CelestialBody::render_blackhole_disc(sf::RenderTarget& window) const
 {
 	if (planetType != BLACKHOLE) return;
-	circle.setPosition(position);
-	auto savedOutline = circle.getOutlineColor();
-	circle.setOutlineColor(sf::Color::Transparent);
-	window.draw(circle);
-	circle.setOutlineColor(savedOutline);
+	drawDisc(window, appearance.fill, sf::Color::Transparent);
 }
 
 void CelestialBody::setColor() noexcept
@@ -709,38 +699,38 @@ void CelestialBody::setColor() noexcept
 		const double r = 100.0 + randBrightness + temp_effect.r;
 		const double g = 100.0 + randBrightness + temp_effect.g + getLife().getBmass() / 20.0;
 		const double b = 100.0 + randBrightness + temp_effect.b;
-		circle.setFillColor(sf::Color(std::clamp(static_cast<int>(r), 0, 255),
+		appearance.fill = sf::Color(std::clamp(static_cast<int>(r), 0, 255),
 			std::clamp(static_cast<int>(g), 0, 255),
-			std::clamp(static_cast<int>(b), 0, 255)));
+			std::clamp(static_cast<int>(b), 0, 255));
 		break;
 		}
 	case GASGIANT:
-		circle.setOutlineThickness(0);
-		circle.setFillColor(sf::Color::Transparent);
+		appearance.outline_thickness = 0;
+		appearance.fill = sf::Color::Transparent;
 		break;
 	case BROWNDWARF:
-		circle.setFillColor(sf::Color(180, 80, 50));
-		circle.setOutlineColor(sf::Color(180, 80, 50, 30));
+		appearance.fill = sf::Color(180, 80, 50);
+		appearance.outline = sf::Color(180, 80, 50, 30);
 		break;
 	case STAR:
-		circle.setFillColor(getStarCol());
-		circle.setOutlineColor(sf::Color(circle.getFillColor().r, circle.getFillColor().g, circle.getFillColor().b,
-			20));
+		appearance.fill = getStarCol();
+		appearance.outline = sf::Color(appearance.fill.r, appearance.fill.g, appearance.fill.b,
+			20);
 		break;
 	case WHITEDWARF:
-		circle.setFillColor(sf::Color(220, 220, 255));
-		circle.setOutlineColor(sf::Color(220, 220, 255, 40));
+		appearance.fill = sf::Color(220, 220, 255);
+		appearance.outline = sf::Color(220, 220, 255, 40);
 		break;
 	case NEUTRONSTAR:
 		if (subType == PULSAR) {
-			circle.setFillColor(sf::Color(140, 230, 255));
-			circle.setOutlineColor(sf::Color(100, 210, 255, 50));
+			appearance.fill = sf::Color(140, 230, 255);
+			appearance.outline = sf::Color(100, 210, 255, 50);
 		} else if (subType == MAGNETAR) {
-			circle.setFillColor(sf::Color(200, 160, 255));
-			circle.setOutlineColor(sf::Color(180, 120, 255, 50));
+			appearance.fill = sf::Color(200, 160, 255);
+			appearance.outline = sf::Color(180, 120, 255, 50);
 		} else {
-			circle.setFillColor(sf::Color(160, 200, 255));
-			circle.setOutlineColor(sf::Color(140, 180, 255, 50));
+			appearance.fill = sf::Color(160, 200, 255);
+			appearance.outline = sf::Color(140, 180, 255, 50);
 		}
 		break;
 	case BLACKHOLE:
@@ -772,8 +762,8 @@ void CelestialBody::updateAtmosphere(int t) noexcept
 		if (atmoCur < 0) atmoCur = 0;
 	}
 
-	circle.setOutlineColor(sf::Color(atmoColor.r, atmoColor.g, atmoColor.b, atmoCur * atmoAlphaMult));
-	circle.setOutlineThickness(sqrt(atmoCur) * atmoThicknessMult);
+	appearance.outline = sf::Color(atmoColor.r, atmoColor.g, atmoColor.b, atmoCur * atmoAlphaMult);
+	appearance.outline_thickness = sqrt(atmoCur) * atmoThicknessMult;
 }
 
 void CelestialBody::updateLife(int t)
@@ -801,7 +791,7 @@ void CelestialBody::colonize(int i, const sf::Color& c, std::string_view d, std:
 	life.giveCivName(std::string(cn));
 }
 
-int CelestialBody::modernRandomWithLimits(int min, int max) const
+int CelestialBody::modernRandomWithLimits(int min, int max)
 {
 	thread_local static std::random_device seeder;
 	thread_local static std::default_random_engine generator(seeder());
@@ -814,7 +804,7 @@ std::string convertDoubleToString(double number)
 	return std::to_string(static_cast<int>(number));
 }
 
-[[nodiscard]] std::string CelestialBody::generate_name()
+std::string CelestialBody::generateName()
 {
 	std::vector<std::string> name_first_part = {
 		"Jup", "Jor", "Ear", "Mar", "Ven", "Cer", "Sat", "Pl", "Nep", "Ur", "Ker", "Mer", "Jov", "Qur", "Deb", "Car",
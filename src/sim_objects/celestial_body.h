@@ -2,17 +2,22 @@
 #include "../CONSTANTS.h"
 #include "SimObject.h"
 #include <SFML/Graphics.hpp>
+#include <array>
+#include <cstdint>
 #include <random>
-#include <vector>
+#include <string>
 #include <string_view>
 #include "../Life.h"
 
 class Space;
 
+/*
+ * Bodies are copied and moved around in bulk (the planet array, its compaction and reordering, breakups),
+ * so only state that is small and allocation-free lives here. The name is kept by Space and generated on
+ * first display, and the disc is drawn with a shared shape set up from `appearance` at render time.
+ */
 class CelestialBody : public SimObject {
 private:
-	std::string name = generate_name();
-
 	//PHYSICAL
 	BodyType planetType;
 
@@ -20,7 +25,7 @@ private:
 	double atmoCur = 0;
 	double atmoPot = modernRandomWithLimits(0, (int)maxAtmo);
 	int numAtmoLines;
-	std::vector<int> atmoLinesBrightness;
+	std::array<int8_t, maxAtmoLayer> atmoLinesBrightness{};
 	sf::Color atmoColor = sf::Color(modernRandomWithLimits(0, 170), modernRandomWithLimits(0, 170), modernRandomWithLimits(0, 170));
 
 	//LIFE
@@ -31,6 +36,8 @@ private:
 	int id;
 	int strongestAttractorId = -1;
 	double strongestAttractorStrength = 0;
+	int timeRung = -1;                         // block timestep rung chosen at the end of the last tick, -1 until assigned
+	sf::Vector2f jerk{ 0.f, 0.f };             // rate of change of the acceleration, carried between ticks by the Hermite integrator
 	bool marked_for_removal = false;
 
 	//STELLAR EVOLUTION
@@ -41,12 +48,18 @@ private:
 
 	//FOR DISINTEGRATION AND IGNORING
 	double disintegrate_grace_end_time = 0;
-	std::vector<int> ignore_ids;
+	int family = -1;                           // bodies of one breakup ignore each other until their grace time ends, -1 if in none
 
 	//GRAPHICS
-	mutable sf::CircleShape circle;
+	struct Appearance
+	{
+		sf::Color fill{ sf::Color::White };
+		sf::Color outline{ sf::Color::White };
+		float outline_thickness{ 0.f };
+		int points{ 30 };
+	};
+	Appearance appearance;
 	int randBrightness;
-	sf::VertexArray light;
 
 public:
 	friend class Space;
@@ -66,12 +79,13 @@ public:
 	[[nodiscard]] int getId() const noexcept override { return id; }
 	[[nodiscard]] int getStrongestAttractorId() const noexcept { return strongestAttractorId; }
 	[[nodiscard]] int getStrongestAttractorIdRef() const noexcept { return strongestAttractorId; }
-	[[nodiscard]] const std::string& getName() const noexcept;
 	[[nodiscard]] bool emitsHeat() const noexcept;
 	[[nodiscard]] std::string getFlavorTextLife() const;
 	[[nodiscard]] sf::Color getStarCol() const noexcept;
 	[[nodiscard]] bool isMarkedForRemoval() const noexcept { return marked_for_removal; }
 	[[nodiscard]] double getStrongestAttractorStrength() const noexcept { return strongestAttractorStrength; }
+	[[nodiscard]] int getTimeRung() const noexcept { return timeRung; }
+	[[nodiscard]] sf::Vector2f getJerk() const noexcept { return jerk; }
 	[[nodiscard]] double fusionEnergy() const noexcept;
 	[[nodiscard]] double thermalEnergy() const noexcept;
 	[[nodiscard]] double giveThermalEnergy(int t) const noexcept;
@@ -87,10 +101,11 @@ public:
 	[[nodiscard]] StellarSubType getSubType() const noexcept { return subType; }
 
 	// Setters
-	void setName(const std::string& n) noexcept { name = n; }
 	void setStrongestAttractorIdRef(int id) noexcept { strongestAttractorId = id; }
 	void markForRemoval() noexcept { marked_for_removal = true; }
 	void setStrongestAttractorStrength(double strength) noexcept { strongestAttractorStrength = strength; }
+	void setTimeRung(int rung) noexcept { timeRung = rung; }
+	void setJerk(const sf::Vector2f& j) noexcept { jerk = j; }
 	void setMass(double m) noexcept override { SimObject::setMass(m); }
 	void setAtmosphere(double a) noexcept { atmoCur = a; }
 	void setAtmospherePotensial(double a) noexcept { atmoPot = a; }
@@ -111,12 +126,14 @@ public:
 	[[nodiscard]] bool canDisintegrate(double curr_time) const noexcept;
 	[[nodiscard]] bool disintegrationGraceTimeIsActive(double curr_time) const noexcept;
 	[[nodiscard]] bool disintegrationGraceTimeOver(double curr_time) const noexcept;
-	[[nodiscard]] bool isIgnoring(int id) const noexcept;
+	[[nodiscard]] int getFamily() const noexcept { return family; }
+	[[nodiscard]] bool inFamily() const noexcept { return family >= 0; }
+	[[nodiscard]] bool isIgnoring(const CelestialBody& other) const noexcept { return family >= 0 && family == other.family; }
 
 	// State modifications
 	void setDisintegrationGraceTime(double grace_time, double curr_time) noexcept;
-	void registerIgnoredId(int id);
-	void clearIgnores() noexcept { ignore_ids.clear(); }
+	void joinFamily(int family_id) noexcept { family = family_id; }
+	void leaveFamily() noexcept { family = -1; }
 	void becomeAbsorbedBy(CelestialBody& absorbing_planet);
 	void updateRadiAndType() noexcept;
 	void initializeRemnantTemperature() noexcept;
@@ -142,6 +159,9 @@ public:
 	void render_blackhole_disc(sf::RenderTarget& window) const;
 	void setColor() noexcept;
 
+	// Random planet name, for Space's name table
+	[[nodiscard]] static std::string generateName();
+
 private:
 	void updateMainSequenceType() noexcept;
 	void updateVisualProperties() noexcept;
@@ -149,8 +169,8 @@ private:
 	void initializeFuel() noexcept;
 	[[nodiscard]] sf::Color getShineColor() const noexcept;
 
-	[[nodiscard]] int modernRandomWithLimits(int min, int max) const;
-	[[nodiscard]] std::string generate_name();
+	[[nodiscard]] static int modernRandomWithLimits(int min, int max);
+	void drawDisc(sf::RenderTarget& window, sf::Color fill, sf::Color outline) const;
 };
 
 // Type alias for backward compatibility during transition
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+
+/*
+ * Generational slot map: hands out int handles and maps each to a value in O(1).
+ *
+ * A handle packs a slot index into its low SLOT_BITS bits and the slot's generation above them. Erasing a
+ * handle frees its slot and advances the generation, so an old handle to a reused slot no longer matches
+ * and find() returns nothing. A slot whose generations are used up is retired instead of reused, so no
+ * handle is ever handed out twice. Handles are non-negative, which leaves -1 free for "none".
+ */
+template <typename T>
+class SlotMap
+{
+public:
+	static constexpr int SLOT_BITS = 22;
+	static constexpr int MAX_SLOTS = 1 << SLOT_BITS;
+	static constexpr int GENERATIONS = 1 << (31 - SLOT_BITS);
+
+	// New handle for `value`, -1 once every slot is taken or retired
+	int insert(const T& value)
+	{
+		int slot;
+		if (!free_slots.empty())
+		{
+			slot = free_slots.back();
+			free_slots.pop_back();
+		}
+		else if (static_cast<int>(slots.size()) < MAX_SLOTS)
+		{
+			slot = static_cast<int>(slots.size());
+			slots.emplace_back();
+		}
+		else
+			return -1;
+
+		slots[slot].value = value;
+		++live;
+		return slots[slot].generation << SLOT_BITS | slot;
+	}
+
+	// Frees the slot of a live handle, stale handles are ignored
+	void erase(int handle)
+	{
+		Slot* slot = liveSlot(handle);
+		if (!slot)
+			return;
+
+		slot->value.reset();
+		--live;
+		if (++slot->generation < GENERATIONS)
+			free_slots.push_back(static_cast<int>(slot - slots.data()));
+	}
+
+	// Value of a live handle, nullptr for a stale or invalid one
+	[[nodiscard]] T* find(int handle)
+	{
+		Slot* slot = liveSlot(handle);
+		return slot ? &*slot->value : nullptr;
+	}
+
+	[[nodiscard]] const T* find(int handle) const
+	{
+		return const_cast<SlotMap*>(this)->find(handle);
+	}
+
+	// Replaces the value of a live handle
+	void set(int handle, const T& value)
+	{
+		if (Slot* slot = liveSlot(handle))
+			slot->value = value;
+	}
+
+	// Erases every live handle, generations and retired slots are kept so the old handles stay stale
+	void clear()
+	{
+		for (size_t k = 0; k < slots.size(); ++k)
+			if (slots[k].value)
+				erase(slots[k].generation << SLOT_BITS | static_cast<int>(k));
+	}
+
+	[[nodiscard]] int size() const noexcept { return live; }
+
+private:
+	struct Slot
+	{
+		std::optional<T> value;
+		int generation{ 0 };
+	};
+
+	Slot* liveSlot(int handle)
+	{
+		if (handle < 0)
+			return nullptr;
+		const int index = handle & (MAX_SLOTS - 1);
+		if (index >= static_cast<int>(slots.size()))
+			return nullptr;
+		Slot& slot = slots[index];
+		return slot.value && slot.generation == handle >> SLOT_BITS ? &slot : nullptr;
+	}
+
+	std::vector<Slot> slots;
+	std::vector<int> free_slots;
+	int live{ 0 };
+};
@@ -1,14 +1,25 @@
 #include "space.h"
 
+#include <atomic>
 #include <sstream>
 #include <iomanip>
 #include <random>
-#include <unordered_map>
+#include <span>
+#include <memory_resource>
+#include <map>
 #include "particles/particle_container.h"
 #include "user_functions.h"
 #include "physics_utils.h"
 #include "roche_limit.h"
+#include "physics/pair_kernel.h"
+#include "physics/block_timesteps.h"
+#include "physics/wisdom_holman.h"
+#include "physics/encounter_subcycling.h"
+#include "physics/swept_contact.h"
+#include "physics/neighbour_list.h"
 #include "StringConstants.h"
+#include "task_pool.h"
+#include "parallel_tuning.h"
 
 namespace {
 StellarSubType rollNeutronStarSubType()
@@ -33,6 +44,7 @@ int Space::addPlanet(Planet&& p)
 	
 	p.setColor();
 
+	aggregates.add(p);
 	pending_planets.push_back(std::move(p));
 	return id;
 }
@@ -43,9 +55,13 @@ void Space::flushPlanets()
 		return;
 
 	for (auto& p : pending_planets)
+	{
+		planet_slots.set(p.getId(), { static_cast<int>(planets.size()), false });
 		planets.push_back(std::move(p));
+	}
 
 	pending_planets.clear();
+	heat_emitters_stale = true;
 }
 
 void Space::addExplosion(sf::Vector2f p, double s, sf::Vector2f v, int l)
@@ -70,7 +86,7 @@ sf::Vector3f Space::centerOfMass(const std::vector<int> & object_ids)
 	auto yCont = 0.0;
 	for (const auto id : object_ids)
 	{
-		if (Planet* planet = findPlanetPtr(id))
+		if (Planet* planet = findPlanet(id))
 		{
 			tMass += planet->getMass();
 			xCont += planet->getMass() * planet->getPosition().x;
@@ -87,7 +103,7 @@ sf::Vector2f Space::centerOfMassVelocity(const std::vector<int> & object_ids)
 	auto yCont = 0.0;
 	for (const auto id : object_ids)
 	{
-		if (Planet * planet = findPlanetPtr(id))
+		if (Planet * planet = findPlanet(id))
 		{
 			tMass += planet->getMass();
 			xCont += planet->getMass()*planet->getVelocity().x;
@@ -116,278 +132,948 @@ void Space::syncConfigToWidgets()
 
 sf::Vector2f Space::centerOfMassAll()
 {
-	double tMass = 0;
-	double xCont = 0;
-	double yCont = 0;
+	return sf::Vector2f(static_cast<float>(aggregates.centerX()), static_cast<float>(aggregates.centerY()));
+}
 
-	for (const auto& planet : planets)
+bool isIgnoringOtherPlanet(const Planet & thisPlanet, const Planet & otherPlanet)
+{
+	return (otherPlanet.isMarkedForRemoval() ||
+		thisPlanet.getId() == otherPlanet.getId() ||
+		thisPlanet.isIgnoring(otherPlanet));
+}
+
+void Space::syncBodyStore()
+{
+	BodyStore& s = body_store;
+	const auto active = [&](const Planet& p) { return p.getMass() >= config.passive_mass; };
+
+	// Slots are kept while every live planet still has its own, with the active bodies first and passive ones
+	// after them, both in planet order. The split follows the masses of this tick.
+	int n_live = 0;
+	for (const Planet& p : planets)
+		n_live += !p.isMarkedForRemoval();
+	bool laid_out = s.size() == n_live;
+	for (int k = 0; k < s.size() && laid_out; ++k)
 	{
-		if (planet.getMass() != -1)
-		{
-			double pMass = planet.getMass();
+		const int i = s.planet[k];
+		laid_out = i < static_cast<int>(planets.size()) && planets[i].getId() == s.id[k] && !planets[i].isMarkedForRemoval() &&
+			active(planets[i]) == s.isSource(k) && (k == 0 || k == s.sources() || s.planet[k - 1] < i);
+	}
 
-			tMass += pMass;
-			xCont += pMass * planet.getPosition().x;
-			yCont += pMass * planet.getPosition().y;
+	if (!laid_out)
+	{
+		// Bodies that had a slot carry their state over in double, new ones start from their planet
+		std::pmr::vector<int> old_slot(planets.size(), -1, frame_arena.resource());
+		for (int k = 0; k < s.size(); ++k)
+		{
+			const PlanetSlot* slot = planet_slots.find(s.id[k]);
+			if (slot && !slot->pending && slot->body == k)
+				old_slot[slot->index] = k;
 		}
+
+		BodyStore& next = body_scratch;
+		next.clear();
+		const auto gather = [&](bool sources) {
+			for (size_t i = 0; i < planets.size(); ++i)
+			{
+				const Planet& p = planets[i];
+				if (p.isMarkedForRemoval() || active(p) != sources) continue;
+
+				if (old_slot[i] >= 0)
+					next.pushFrom(s, old_slot[i], static_cast<int>(i));
+				else
+				{
+					const auto pos = p.getPosition();
+					const auto vel = p.getVelocity();
+					const auto acc = p.getAcceleration();
+					const auto jerk = p.getJerk();
+					next.push(pos.x, pos.y, vel.x, vel.y, acc.x, acc.y, p.getMass(), p.getRadius(), 0.0, 0.0,
+						p.getType(), p.getId(), static_cast<int>(i), p.getTimeRung(), jerk.x, jerk.y, p.getFamily());
+				}
+				planet_slots.find(p.getId())->body = next.size() - 1;
+			}
+		};
+		gather(true);
+		const int n_active = next.size();
+		if (config.passive_mass > 0.0)
+			gather(false);
+		next.n_sources = n_active;
+		std::swap(body_store, body_scratch);
 	}
 
-	if (tMass == 0) return {0, 0};
-	return sf::Vector2f(xCont / tMass, yCont / tMass);
+	// Per-tick constants from the planets, which masses, heat and families are still kept on
+	for (int k = 0; k < s.size(); ++k)
+	{
+		const int i = s.planet[k];
+		const Planet& p = planets[i];
+		s.mass[k] = p.getMass();
+		s.g_mass[k] = G * p.getMass();
+		s.radius[k] = p.getRadius();
+		s.heat[k] = (config.heat_enabled && p.emitsHeat()) ? p.giveThermalEnergy(1) : 0.0;
+		s.type[k] = p.getType();
+		s.family[k] = p.getFamily();
+	}
+	s.startTick();
+
+	// Encounter subcycling starts from the strongest attractors of the last tick, as slots
+	if (config.encounter_subcycling)
+	{
+		for (int k = 0; k < s.size(); ++k)
+			s.strongest_slot[k] = bodySlot(planets[s.planet[k]].getStrongestAttractorIdRef());
+	}
 }
 
-bool isIgnoringOtherPlanet(const Planet & thisPlanet, const Planet & otherPlanet)
+int Space::bodySlot(int id) const
 {
-	return (otherPlanet.isMarkedForRemoval() ||
-		thisPlanet.getId() == otherPlanet.getId() ||
-		thisPlanet.isIgnoring(otherPlanet.getId()));
+	const PlanetSlot* slot = planet_slots.find(id);
+	if (!slot || slot->pending || slot->body < 0 || slot->body >= body_store.size() || body_store.id[slot->body] != id)
+		return -1;
+	return slot->body;
+}
+
+std::optional<Space::PlanetMotion> Space::getPlanetMotion(int id)
+{
+	const Planet* planet = findPlanet(id);
+	if (!planet)
+		return std::nullopt;
+	const int k = bodySlot(id);
+	if (k >= 0)
+		return PlanetMotion{ body_store.x[k], body_store.y[k], body_store.vx[k], body_store.vy[k] };
+	return PlanetMotion{ planet->getx(), planet->gety(), planet->getxv(), planet->getyv() };
+}
+
+bool Space::setPlanetMotion(int id, const PlanetMotion& motion)
+{
+	Planet* planet = findPlanet(id);
+	if (!planet)
+		return false;
+	if (const int k = bodySlot(id); k >= 0)
+	{
+		body_store.x[k] = motion.x;
+		body_store.y[k] = motion.y;
+		body_store.vx[k] = motion.vx;
+		body_store.vy[k] = motion.vy;
+	}
+	aggregates.remove(*planet);
+	planet->setPosition(sf::Vector2f(static_cast<float>(motion.x), static_cast<float>(motion.y)));
+	planet->setVelocity(sf::Vector2f(static_cast<float>(motion.vx), static_cast<float>(motion.vy)));
+	if (!planet->isMarkedForRemoval())
+		aggregates.add(*planet);
+	return true;
+}
+
+void Space::indexPlanets()
+{
+	planet_index_entries.clear();
+	for (size_t i = 0; i < planets.size(); ++i)
+		planet_index_entries.push_back({ planets[i].getx(), planets[i].gety(), planets[i].getRadius(), static_cast<int>(i) });
+	planet_index.build(planet_index_entries);
+}
+
+void Space::reorderObjects()
+{
+	// Planets are referred to by id between ticks, so moving them only costs the slot-keyed caches a rebuild
+	if (planet_order.reorder(planets, [](const Planet& p) { return p.getPosition(); }, config.reorder_disorder, reorder_scratch))
+		for (size_t k = 0; k < planets.size(); ++k)
+			planet_slots.find(planets[k].getId())->index = static_cast<int>(k);
+	particles->reorder(config.reorder_disorder);
+}
+
+void Space::gatherTreeBodies()
+{
+	const BodyStore& s = body_store;
+	tree_bodies.clear();
+	for (int k = 0; k < s.sources(); ++k)
+		tree_bodies.push_back({ s.x[k], s.y[k], s.g_mass[k], 0.0, k });	// contacts come from the neighbour list
 }
 
 void Space::update()
 {
+	frame_arena.reset();
+
+	// Between ticks, so no pass of the pool is running. The schedules of the loops follow the thread count.
+	TaskPool::global().setThreadCount(config.worker_threads);
+	ParallelTuning::global().update(config.parallel_autotune);
+	const ParallelTuning& tuning = ParallelTuning::global();
+
 	flushPlanets();
 	curr_time += timestep;
 
-	//SETUP & OTHER
-	total_mass = 0;
+	// Planets added since the last tick are appended, so the index only has to catch up on them
+	if (planet_index.size() != planets.size())
+		indexPlanets();
 
+	//SETUP & OTHER
 	if (!planets.empty())
 		iteration += 1;
 
 	update_spaceship();
 
-	particles->update(planets, bound, timestep, curr_time, config.gravity_enabled, config.heat_enabled);
+	particles->update(planets, planet_index, bound, timestep, curr_time, config.gravity_enabled, config.heat_enabled);
 
-	const size_t n_planets = planets.size();
-	if (n_planets == 0) return;
+	if (planets.empty()) return;
 
-	// Prepare Hot Data and Accelerations
-	if (hot_planets.size() < n_planets) hot_planets.resize(n_planets);
-	if (accelerations.size() < n_planets) accelerations.resize(n_planets);
+	// The live bodies, with their motion carried over from the last tick and removed bodies compacted out
+	syncBodyStore();
+	BodyStore& s = body_store;
+	const int n_bodies = s.size();
 
-	for (size_t i = 0; i < n_planets; ++i)
+	// Block timesteps: the tick is cut into 2^top_rung substeps and a body on rung r is kicked and
+	// evaluated every 2^(top_rung - r) of them. Without block timesteps every body is on rung 0.
+	// Bodies without a rung yet start on the finest one and coarsen once their motion is known.
+	int top_rung = 0;
+	const bool block_timesteps = config.block_timesteps && config.gravity_enabled;
+	for (int k = 0; k < n_bodies; ++k)
 	{
-		hot_planets[i].x = planets[i].getPosition().x;
-		hot_planets[i].y = planets[i].getPosition().y;
-		hot_planets[i].mass = planets[i].getMass();
-		hot_planets[i].radius = planets[i].getRadius();
-		hot_planets[i].radius_sq = hot_planets[i].radius * hot_planets[i].radius;
-		hot_planets[i].g_mass = G * hot_planets[i].mass;
-		hot_planets[i].id = planets[i].getId();
-		hot_planets[i].type = planets[i].getType();
-		hot_planets[i].thermalEnergyOutput = (config.heat_enabled && planets[i].emitsHeat()) ? planets[i].giveThermalEnergy(1) : 0.0;
-		hot_planets[i].strongestAttractorMag = 0;
-		hot_planets[i].strongestAttractorId = -1;
-		hot_planets[i].accumulatedHeat = 0;
-		
-		accelerations[i] = planets[i].getAcceleration();
+		if (!block_timesteps)
+			s.rung[k] = 0;
+		else if (s.rung[k] < 0)
+			s.rung[k] = config.max_time_rung;
+		else
+			s.rung[k] = std::min(s.rung[k], config.max_time_rung);
+		top_rung = std::max(top_rung, s.rung[k]);
 	}
+	const int n_substeps = 1 << top_rung;
+	const double sub_dt = timestep / n_substeps;
+	const auto step_of = [&](int k) { return 1 << (top_rung - s.rung[k]); };	// in substeps
+
+	collision_buffers.reset();
+	roche_buffers.reset();
+
+	// Per-body state of the pass, shared by all solvers
+	struct PairPass
+	{
+		int i;
+		double xi, yi;
+		double mi, ri;
+		bool can_disintegrate_i;
+		bool has_ignores_i;
+		double ax{ 0.0 };
+		double ay{ 0.0 };
+		double max_force{ 0.0 };
+		int max_slot{ -1 };
+		int event_slot{ -1 };		// body behind the earliest event of body i in this pass
+		bool event_roche{ false };
+		double event_time{ 0.0 };	// time of impact since the start of the tick
+	};
 
-	// --- PHASE 1: FIRST KICK + DRIFT ---
-	const float half_dt = timestep * 0.5f;
-	const float dt = timestep;
+	// Compact remnants always absorb less dense objects
+	const auto compactness = [](BodyType t) {
+		if (t == BLACKHOLE)    return 3;
+		if (t == NEUTRONSTAR)  return 2;
+		if (t == WHITEDWARF)   return 1;
+		return 0;
+	};
+
+	// Continuous checks follow the paths since the start of the tick, sweep_elapsed long. 0 checks the current positions only.
+	double sweep_elapsed = 0.0;
 
-	#pragma omp parallel for if(n_planets > 50)
-	for (int i = 0; i < static_cast<int>(n_planets); ++i)
+	// Roche breakup or absorption of body i by body j. Keeps the earliest such event of body i in the pass.
+	const auto pair_event = [&](PairPass& pass, int j, double dist)
 	{
-		if (planets[i].isMarkedForRemoval()) continue;
+		// Already consumed in an earlier pass of this tick
+		if (s.has_event[pass.i]) return;
+
+		// Out of reach even along the swept paths
+		if (dist >= s.reach[pass.i] + s.reach[j]) return;
+
+		const double rad_dist = pass.ri + s.radius[j];
+		const BodyType type_j = s.type[j];
+		const bool remnant_j = type_j == BLACKHOLE || type_j == NEUTRONSTAR || type_j == WHITEDWARF;
 
-		if (config.gravity_enabled)
+		const auto impact = [&](double range) {
+			if (sweep_elapsed > 0.0)
+			{
+				const double t = swept_paths.timeOfImpact(pass.i, j, range);
+				return t >= 0.0 ? t * sweep_elapsed : -1.0;
+			}
+			return dist < range ? 0.0 : -1.0;
+		};
+		const auto keep = [&](double time, bool roche) {
+			if (time < 0.0 || (pass.event_slot >= 0 && time >= pass.event_time)) return;
+			pass.event_slot = j;
+			pass.event_roche = roche;
+			pass.event_time = time;
+		};
+
+		// Roche Limit, which lies outside the collision range so it is always reached first
+		if (pass.can_disintegrate_i && RocheLimit::checkMassRatio(pass.mi, s.mass[j], remnant_j))
 		{
-			sf::Vector2f vel = planets[i].getVelocity();
-			vel.x += accelerations[i].x * half_dt;
-			vel.y += accelerations[i].y * half_dt;
-			planets[i].setVelocity(vel);
+			keep(impact(RocheLimit::calculateLimitRadius(rad_dist, remnant_j)), true);
+			return;
 		}
-		
-		sf::Vector2f pos = planets[i].getPosition();
-		pos.x += planets[i].getVelocity().x * dt;
-		pos.y += planets[i].getVelocity().y * dt;
-		planets[i].setPosition(pos);
 
-		hot_planets[i].x = pos.x;
-		hot_planets[i].y = pos.y;
-	}
+		// Collision, where planet i is absorbed
+		const int ci = compactness(s.type[pass.i]);
+		const int cj = compactness(type_j);
+		if (ci < cj || (ci == cj && pass.mi <= s.mass[j]))
+			keep(impact(rad_dist), false);
+	};
+
+	// Records the earliest event of the pass, once per body and tick, in the buffer of the calling thread
+	const auto record_event = [&](const PairPass& pass) {
+		if (pass.event_slot < 0 || s.has_event[pass.i]) return;
+		s.has_event[pass.i] = 1;
+		if (pass.event_roche)
+			roche_buffers.local().push_back({ s.planet[pass.i], pass.event_time });
+		else
+			collision_buffers.local().push_back({ s.planet[pass.i], s.planet[pass.event_slot], pass.event_time });
+	};
+
+	// Collision and Roche checks of body i against its neighbour list
+	const auto near_events = [&](PairPass& pass)
+	{
+		for (const int j : neighbour_list.of(pass.i))
+		{
+			if (pass.has_ignores_i && s.family[j] == s.family[pass.i]) continue;
+			const double dx = s.x[j] - pass.xi;
+			const double dy = s.y[j] - pass.yi;
+			pair_event(pass, j, std::sqrt(std::max(dx*dx + dy*dy, 0.01)));
+		}
+	};
 
-	// --- PHASE 2: BIG UNIFIED PASS (Gravity, Heat, Collisions, Roche) ---
-	std::vector<CollisionEvent> collision_events;
-	std::vector<RocheEvent> roche_events;
-	collision_events.reserve(16);
-	roche_events.reserve(16);
+	// Gravity term of this tick. The kernels and the scalar pair loops below are compiled with and without it,
+	// and the variant is picked once per pass. Heat is not part of the pair passes, see the emitters at SYNC.
+	const PairKernel::Terms terms{ config.gravity_enabled, false };
 
-	#pragma omp parallel if(n_planets > 50)
+	// Exact gravity of body j on body i, for bodies in or out of a fragment family
+	const auto interact = [&](auto gravity, auto ignores, PairPass& pass, int j)
 	{
-		#pragma omp for schedule(static)
-		for (int i = 0; i < static_cast<int>(n_planets); ++i)
+		if constexpr (ignores) {
+			if (s.family[j] == s.family[pass.i]) return;
+		}
+
+		if constexpr (gravity)
+		{
+			const double dx = s.x[j] - pass.xi;
+			const double dy = s.y[j] - pass.yi;
+			const double dist2 = std::max(dx*dx + dy*dy, 0.01);
+			const double dist = std::sqrt(dist2);
+
+			const double g_mj = s.g_mass[j];
+			const double factor = g_mj / (dist2 * dist);
+			pass.ax += factor * dx;
+			pass.ay += factor * dy;
+
+			const double force_mag = g_mj / dist2;
+			if (force_mag > pass.max_force) {
+				pass.max_force = force_mag;
+				pass.max_slot = j;
+			}
+		}
+	};
+
+	const auto make_pass = [&](int i) {
+		const Planet& p = planets[s.planet[i]];
+		return PairPass{ i, s.x[i], s.y[i], s.mass[i], s.radius[i], p.canDisintegrate(curr_time), s.family[i] >= 0 };
+	};
+
+	const auto store_pass = [&](const PairPass& pass) {
+		const int i = pass.i;
+		s.ax[i] = config.gravity_enabled ? pass.ax : 0.0;
+		s.ay[i] = config.gravity_enabled ? pass.ay : 0.0;
+		s.strongest_force[i] = config.gravity_enabled ? pass.max_force : 0.0;
+		s.strongest_slot[i] = config.gravity_enabled ? pass.max_slot : -1;
+		record_event(pass);
+	};
+
+	// Turns kernel sums into the body's pass, with event checks on the neighbour list where the kernel saw contact
+	const auto finish_direct = [&](auto gravity, int i, const PairKernel::Sums& sum) {
+		PairPass pass = make_pass(i);
+
+		if (pass.has_ignores_i)
+		{
+			// Pairs within a family must not contribute, so fragments in their grace period take the scalar path
+			for (int j = 0; j < s.sources(); ++j)
+				if (j != i) interact(gravity, std::true_type{}, pass, j);
+			near_events(pass);
+			store_pass(pass);
+			return;
+		}
+
+		pass.ax = sum.ax;
+		pass.ay = sum.ay;
+		pass.max_force = sum.max_force;
+		pass.max_slot = sum.max_slot;
+
+		// The kernels do not see passive bodies, so with any around the neighbour list is always checked
+		if (sum.contact || s.sources() < n_bodies)
+			near_events(pass);
+		store_pass(pass);
+	};
+
+	// Rung wanted after the body's latest force evaluation, which ended a step of step_of(k) substeps
+	const auto wanted_rung = [&](int k) {
+		const double step_time = step_of(k) * sub_dt;
+		const double jerk = std::hypot(s.ax[k] - s.step_ax[k], s.ay[k] - s.step_ay[k]) / step_time;
+		const int j = s.strongest_slot[k];
+		return BlockTimesteps::rungFor(timestep, config.time_rung_eta, config.max_time_rung, std::hypot(s.ax[k], s.ay[k]), jerk,
+			s.strongest_force[k], j >= 0 ? s.g_mass[j] : 0.0, j >= 0 ? std::hypot(s.vx[k] - s.vx[j], s.vy[k] - s.vy[j]) : 0.0);
+	};
+
+	// Partial substep passes only refresh what their bodies see, once a full refresh of this tick has set up
+	// the neighbour lists and the Barnes-Hut tree they build on
+	bool neighbours_current = false;
+	bool barnes_hut_current = false;
+
+	const auto refresh_reach = [&](int k) {
+		s.reach[k] = RocheLimit::REMNANT_DIST_MULTIPLIER * s.radius[k] + (sweep_elapsed > 0.0 ? swept_paths.reachExtension(k) : 0.0);
+	};
+
+	// Forces, heat and events for the given slots, against all bodies at their current positions.
+	// Events are checked along the paths of the last `elapsed` time since the start of the tick.
+	const auto force_pass = [&](const std::vector<int>& targets, double elapsed) {
+		const int n_targets = static_cast<int>(targets.size());
+		const bool full = n_targets == n_bodies;
+
+		// Swept paths widen each body's reach by how far it came, so the kernels' contact flags cover them.
+		// Events are only checked on the neighbour lists, so a partial pass refreshes its bodies and their
+		// listed neighbours. The full pass at the end of the tick checks every body along the whole tick.
+		sweep_elapsed = config.continuous_collisions && elapsed > 0.0 ? elapsed : 0.0;
+		bool refreshed = false;
+		if (!full && neighbours_current)
 		{
-			if (planets[i].isMarkedForRemoval()) continue;
-
-			double ax = 0.0;
-			double ay = 0.0;
-			double max_force = 0.0;
-			int max_id = -1;
-			double total_heat = 0.0;
-
-			const float xi = hot_planets[i].x;
-			const float yi = hot_planets[i].y;
-			const double mi = hot_planets[i].mass;
-			const double ri = hot_planets[i].radius;
-			const double ri2 = hot_planets[i].radius_sq;
-			const int id_i = hot_planets[i].id;
-			const bool can_disintegrate_i = planets[i].canDisintegrate(curr_time);
-			const bool has_ignores_i = !planets[i].ignore_ids.empty();
-
-			for (size_t j = 0; j < n_planets; ++j)
+			in_pass_slots.resize(n_bodies, 0);
+			pass_slots.clear();
+			const auto mark = [&](int k) {
+				if (in_pass_slots[k]) return;
+				in_pass_slots[k] = 1;
+				pass_slots.push_back(k);
+			};
+			for (const int i : targets)
 			{
-				if (i == static_cast<int>(j) || planets[j].isMarkedForRemoval()) continue;
+				mark(i);
+				for (const int j : neighbour_list.of(i))
+					mark(j);
+			}
+			for (const int k : pass_slots)
+				in_pass_slots[k] = 0;
+
+			if (sweep_elapsed > 0.0)
+				swept_paths.build(s, sweep_elapsed, pass_slots);
+			for (const int k : pass_slots)
+				refresh_reach(k);
+			refreshed = neighbour_list.valid(s, config.neighbour_skin, pass_slots);
+		}
+		if (!refreshed)
+		{
+			if (sweep_elapsed > 0.0)
+				swept_paths.build(s, sweep_elapsed);
+			for (int k = 0; k < n_bodies; ++k)
+				refresh_reach(k);
+
+			// Short-range pairs for the event checks, kept until a body moves too far
+			neighbour_list.update(s, config.neighbour_skin);
+			neighbours_current = true;
+		}
 
-				if (has_ignores_i) {
-					if (planets[i].isIgnoring(hot_planets[j].id)) continue;
-				}
+		// The FMM translates the whole tree, so partial substep passes walk a Barnes-Hut tree instead.
+		// Trees only hold the active bodies, and passive ones, which the FMM cannot evaluate, walk Barnes-Hut as well.
+		// Partial passes refit the tree of an earlier pass of the tick rather than build their own.
+		const bool use_fmm = config.gravity_solver == GravitySolver::FMM && full;
+		const bool use_barnes_hut = config.gravity_solver == GravitySolver::BARNES_HUT ||
+			(config.gravity_solver == GravitySolver::FMM && (!full || s.sources() < n_bodies));
+		const bool refit = use_barnes_hut && !full && barnes_hut_current;
+		if (use_fmm || (use_barnes_hut && !refit))
+			gatherTreeBodies();
+		if (refit)
+			barnes_hut.refit(s.x.data(), s.y.data());
+		else if (use_barnes_hut)
+		{
+			barnes_hut.build(tree_bodies);
+			barnes_hut_current = true;
+		}
+		if (use_fmm)
+			fmm.build(tree_bodies, config.fmm_order, config.fmm_theta);
 
-				const double dx = static_cast<double>(hot_planets[j].x) - xi;
-				const double dy = static_cast<double>(hot_planets[j].y) - yi;
-				const double dist2 = std::max(dx*dx + dy*dy, 0.01);
-				const double dist = std::sqrt(dist2);
-				const double rad_dist = ri + hot_planets[j].radius;
+		PairKernel::withTerms(terms, [&](auto gravity, auto) {
+			if (use_barnes_hut || use_fmm)
+			{
+				TaskPool::global().parallelFor(0, n_targets, tuning.schedule(ParallelLoop::BODY_FORCE), [&](int t) {
+					const int i = targets[t];
+					PairPass pass = make_pass(i);
+					const auto near = [&](auto ignores) {
+						return [&, ignores](const TreeBody& body) {
+							if (body.index != i) interact(gravity, ignores, pass, body.index);
+							return true;
+						};
+					};
 
-				// Gravity
-				if (config.gravity_enabled) {
-					const double g_mj = hot_planets[j].g_mass;
-					const double factor = g_mj / (dist2 * dist);
-					ax += factor * dx;
-					ay += factor * dy;
-
-					const double force_mag = g_mj / dist2;
-					if (force_mag > max_force) {
-						max_force = force_mag;
-						max_id = hot_planets[j].id;
+					FarField far;
+					const auto walk = [&](auto&& near_fn) {
+						if (use_fmm && s.isSource(i))
+							fmm.query(i, far, near_fn);
+						else
+							barnes_hut.walk(pass.xi, pass.yi, 0.0, config.barnes_hut_theta, far, near_fn);
+					};
+					if (pass.has_ignores_i)
+						walk(near(std::true_type{}));
+					else
+						walk(near(std::false_type{}));
+
+					pass.ax += far.ax;
+					pass.ay += far.ay;
+					if (far.max_force > pass.max_force) {
+						pass.max_force = far.max_force;
+						pass.max_slot = far.max_index;
 					}
-				}
+					near_events(pass);
+					store_pass(pass);
+				});
+			}
+			else if (full && config.gravity_precision == GravityPrecision::DOUBLE && config.symmetric_pairs &&
+				SymmetricPairKernel::balances(s.sources(), TaskPool::global().threadCount()))
+			{
+				// Each pair evaluated once and applied to both bodies, when there are enough tile pairs to keep the threads busy
+				symmetric_kernel.accumulate(s, pair_sums, terms);
 
-				// Heat
-				if (config.heat_enabled && hot_planets[j].thermalEnergyOutput > 0) {
-					const auto heat = tempConstTwo * ri2 * hot_planets[j].thermalEnergyOutput / std::max(dist, 1.0);
-					total_heat += heat;
-				}
+				TaskPool::global().parallelFor(0, n_bodies, tuning.schedule(ParallelLoop::BODY_FORCE), [&](int i) {
+					finish_direct(gravity, i, pair_sums[i]);
+				});
+			}
+			else
+			{
+				// Vectorized direct sum in blocks of bodies, in float lanes for the mixed precision mode
+				const bool mixed = config.gravity_precision == GravityPrecision::MIXED;
+				if (mixed)
+					mixed_kernel.prepare(s);
+
+				constexpr int BLOCK = 16;
+				const int n_blocks = (n_targets + BLOCK - 1) / BLOCK;
+
+				TaskPool::global().parallelFor(0, n_blocks, tuning.schedule(ParallelLoop::BODY_FORCE).perBlock(BLOCK), [&](int block) {
+					const int t_begin = block * BLOCK;
+					const int t_end = std::min(t_begin + BLOCK, n_targets);
+					PairKernel::Sums sums[BLOCK];
+					if (mixed)
+						mixed_kernel.accumulate(targets.data() + t_begin, t_end - t_begin, sums, terms);
+					else
+						PairKernel::accumulate(s, targets.data() + t_begin, t_end - t_begin, sums, terms);
+
+					for (int t = t_begin; t < t_end; ++t)
+						finish_direct(gravity, targets[t], sums[t - t_begin]);
+				});
+			}
+		});
+	};
+
+	// Jerk of every body for the Hermite corrector. Pairs within a family must not contribute, as in the force pass.
+	const auto jerk_pass = [&]() {
+		constexpr int BLOCK = 16;
+		const int n_blocks = (n_bodies + BLOCK - 1) / BLOCK;
+
+		TaskPool::global().parallelFor(0, n_blocks, tuning.schedule(ParallelLoop::BODY_FORCE).perBlock(BLOCK), [&](int block) {
+			const int i_begin = block * BLOCK;
+			const int i_end = std::min(i_begin + BLOCK, n_bodies);
+			PairKernel::accumulateJerk(s, i_begin, i_end, s.jx.data() + i_begin, s.jy.data() + i_begin);
+			PairKernel::removeFamilyJerk(s, i_begin, i_end, s.jx.data() + i_begin, s.jy.data() + i_begin);
+		});
+	};
+
+	// Whole-tick kicks and drifts for the composed integrators
+	const auto kick_all = [&](double dt) {
+		TaskPool::global().parallelFor(0, n_bodies, tuning.schedule(ParallelLoop::BODY_UPDATE), [&](int k) {
+			s.vx[k] += s.ax[k] * dt;
+			s.vy[k] += s.ay[k] * dt;
+		});
+	};
+	const auto drift_all = [&](double dt) {
+		TaskPool::global().parallelFor(0, n_bodies, tuning.schedule(ParallelLoop::BODY_UPDATE), [&](int k) {
+			s.x[k] += s.vx[k] * dt;
+			s.y[k] += s.vy[k] * dt;
+		});
+	};
+
+	// The fourth-order integrators step the whole tick at once, block timesteps always use the leapfrog.
+	// Without gravity there is nothing to integrate beyond the drift, so the single pass leapfrog is used.
+	Integrator integrator = (block_timesteps || !config.gravity_enabled) ? Integrator::LEAPFROG : config.integrator;
+
+	// Wisdom-Holman needs one active body dominating the mass and no close pairs among the others this tick
+	const int central = integrator == Integrator::WISDOM_HOLMAN ? WisdomHolman::dominantBody(s) : -1;
+	if (integrator == Integrator::WISDOM_HOLMAN && (central < 0 || !s.isSource(central) || WisdomHolman::hasCloseEncounter(s, central, timestep, frame_arena.resource())))
+		integrator = Integrator::LEAPFROG;
+
+	if (integrator == Integrator::YOSHIDA4)
+	{
+		// Three leapfrog steps of w1, w0 and w1 ticks with the kicks between them merged. w0 is negative,
+		// so the middle drift runs backwards. The opening kick reuses the acceleration of the last tick.
+		const double cbrt2 = std::cbrt(2.0);
+		const double w1 = 1.0 / (2.0 - cbrt2);
+		const double w0 = -cbrt2 * w1;
+		const double drifts[3] = { w1, w0, w1 };
+		const double kicks[4] = { 0.5 * w1, 0.5 * (w1 + w0), 0.5 * (w0 + w1), 0.5 * w1 };
+
+		active_slots.resize(n_bodies);
+		std::iota(active_slots.begin(), active_slots.end(), 0);
+
+		// Tick fraction drifted so far. The backward stage ends before the tick starts and is only checked where it ends.
+		double elapsed = 0.0;
+		kick_all(kicks[0] * timestep);
+		for (int stage = 0; stage < 3; ++stage)
+		{
+			drift_all(drifts[stage] * timestep);
+			elapsed += drifts[stage];
+			force_pass(active_slots, elapsed * timestep);
+			force_evaluations += n_bodies;
+			kick_all(kicks[stage + 1] * timestep);
+		}
+	}
+	else if (integrator == Integrator::WISDOM_HOLMAN)
+	{
+		// Democratic heliocentric splitting: the other bodies follow exact Kepler orbits around the central
+		// one in heliocentric positions and barycentric velocities, are kicked by each other's pull, and
+		// are shifted by the recoil of the central body. Kick, shift, Kepler drift, shift, kick.
+		const double m0 = s.mass[central];
+		const double g_m0 = s.g_mass[central];
+
+		// The kicks only carry the pull of the other bodies, so the central body's share is taken out of a
+		const auto remove_central_pull = [&](int k, double& ax, double& ay) {
+			const double dx = s.x[central] - s.x[k];
+			const double dy = s.y[central] - s.y[k];
+			const double dist2 = std::max(dx*dx + dy*dy, 0.01);
+			const double factor = g_m0 / (dist2 * std::sqrt(dist2));
+			ax = s.ax[k] - factor * dx;
+			ay = s.ay[k] - factor * dy;
+		};
+		const auto interaction_kick = [&](double dt) {
+			TaskPool::global().parallelFor(0, n_bodies, tuning.schedule(ParallelLoop::BODY_UPDATE), [&](int k) {
+				if (k == central) return;
+				double ax, ay;
+				remove_central_pull(k, ax, ay);
+				s.vx[k] += ax * dt;
+				s.vy[k] += ay * dt;
+			});
+		};
+
+		// Barycentre, which moves in a straight line
+		double total_mass = 0.0, cm_x = 0.0, cm_y = 0.0, cm_vx = 0.0, cm_vy = 0.0;
+		for (int k = 0; k < n_bodies; ++k)
+		{
+			total_mass += s.mass[k];
+			cm_x += s.mass[k] * s.x[k];
+			cm_y += s.mass[k] * s.y[k];
+			cm_vx += s.mass[k] * s.vx[k];
+			cm_vy += s.mass[k] * s.vy[k];
+		}
+		cm_x /= total_mass; cm_y /= total_mass;
+		cm_vx /= total_mass; cm_vy /= total_mass;
+
+		// Opening kick from the pull of the last tick, then to heliocentric positions and barycentric velocities
+		interaction_kick(0.5 * timestep);
+		for (int k = 0; k < n_bodies; ++k)
+		{
+			if (k == central) continue;
+			s.x[k] -= s.x[central];
+			s.y[k] -= s.y[central];
+			s.vx[k] -= cm_vx;
+			s.vy[k] -= cm_vy;
+		}
+
+		const auto recoil_shift = [&](double dt) {
+			double px = 0.0, py = 0.0;
+			for (int k = 0; k < n_bodies; ++k)
+			{
+				if (k == central) continue;
+				px += s.mass[k] * s.vx[k];
+				py += s.mass[k] * s.vy[k];
+			}
+			for (int k = 0; k < n_bodies; ++k)
+			{
+				if (k == central) continue;
+				s.x[k] += px / m0 * dt;
+				s.y[k] += py / m0 * dt;
+			}
+		};
+
+		recoil_shift(0.5 * timestep);
+		TaskPool::global().parallelFor(0, n_bodies, tuning.schedule(ParallelLoop::BODY_FORCE), [&](int k) {
+			if (k != central)
+				WisdomHolman::keplerDrift(g_m0, s.x[k], s.y[k], s.vx[k], s.vy[k], timestep);
+		});
+		recoil_shift(0.5 * timestep);
+
+		// Back to the simulation frame, the central body is placed so the barycentre stays on its line
+		cm_x += cm_vx * timestep;
+		cm_y += cm_vy * timestep;
+		double offset_x = 0.0, offset_y = 0.0;
+		for (int k = 0; k < n_bodies; ++k)
+		{
+			if (k == central) continue;
+			offset_x += s.mass[k] * s.x[k];
+			offset_y += s.mass[k] * s.y[k];
+		}
+		s.x[central] = cm_x - offset_x / total_mass;
+		s.y[central] = cm_y - offset_y / total_mass;
+		for (int k = 0; k < n_bodies; ++k)
+		{
+			if (k == central) continue;
+			s.x[k] += s.x[central];
+			s.y[k] += s.y[central];
+			s.vx[k] += cm_vx;
+			s.vy[k] += cm_vy;
+		}
+
+		active_slots.resize(n_bodies);
+		std::iota(active_slots.begin(), active_slots.end(), 0);
+		force_pass(active_slots, timestep);
+		force_evaluations += n_bodies;
 
-				// Roche Limit
-				if (can_disintegrate_i &&
-					RocheLimit::isBreached(dist, rad_dist, mi, hot_planets[j].mass, hot_planets[j].type == BLACKHOLE || hot_planets[j].type == NEUTRONSTAR || hot_planets[j].type == WHITEDWARF))
+		// Closing kick, and the central body takes whatever momentum the others do not carry
+		interaction_kick(0.5 * timestep);
+		double momentum_x = 0.0, momentum_y = 0.0;
+		for (int k = 0; k < n_bodies; ++k)
+		{
+			if (k == central) continue;
+			momentum_x += s.mass[k] * s.vx[k];
+			momentum_y += s.mass[k] * s.vy[k];
+		}
+		s.vx[central] = (total_mass * cm_vx - momentum_x) / m0;
+		s.vy[central] = (total_mass * cm_vy - momentum_y) / m0;
+	}
+	else if (integrator == Integrator::HERMITE4)
+	{
+		// Predict the end of the tick from acceleration and jerk, evaluate both there, then correct with
+		// the Hermite interpolation of the acceleration between the two ends
+		const double dt = timestep;
+		const double dt2 = dt * dt;
+
+		TaskPool::global().parallelFor(0, n_bodies, tuning.schedule(ParallelLoop::BODY_UPDATE), [&](int k) {
+			s.step_x[k] = s.x[k];		s.step_y[k] = s.y[k];
+			s.step_vx[k] = s.vx[k];		s.step_vy[k] = s.vy[k];
+			s.step_ax[k] = s.ax[k];		s.step_ay[k] = s.ay[k];
+			s.step_jx[k] = s.jx[k];		s.step_jy[k] = s.jy[k];
+
+			s.x[k] += s.vx[k] * dt + s.ax[k] * dt2 / 2.0 + s.jx[k] * dt2 * dt / 6.0;
+			s.y[k] += s.vy[k] * dt + s.ay[k] * dt2 / 2.0 + s.jy[k] * dt2 * dt / 6.0;
+			s.vx[k] += s.ax[k] * dt + s.jx[k] * dt2 / 2.0;
+			s.vy[k] += s.ay[k] * dt + s.jy[k] * dt2 / 2.0;
+		});
+
+		active_slots.resize(n_bodies);
+		std::iota(active_slots.begin(), active_slots.end(), 0);
+		force_pass(active_slots, timestep);
+		jerk_pass();
+		force_evaluations += n_bodies;
+
+		TaskPool::global().parallelFor(0, n_bodies, tuning.schedule(ParallelLoop::BODY_UPDATE), [&](int k) {
+			const double vx = s.step_vx[k] + (s.step_ax[k] + s.ax[k]) * dt / 2.0 + (s.step_jx[k] - s.jx[k]) * dt2 / 12.0;
+			const double vy = s.step_vy[k] + (s.step_ay[k] + s.ay[k]) * dt / 2.0 + (s.step_jy[k] - s.jy[k]) * dt2 / 12.0;
+			s.x[k] = s.step_x[k] + (s.step_vx[k] + vx) * dt / 2.0 + (s.step_ax[k] - s.ax[k]) * dt2 / 12.0;
+			s.y[k] = s.step_y[k] + (s.step_vy[k] + vy) * dt / 2.0 + (s.step_ay[k] - s.ay[k]) * dt2 / 12.0;
+			s.vx[k] = vx;
+			s.vy[k] = vy;
+		});
+	}
+	else
+	{
+		// Close pairs found by the last force pass move through the tick on their own substeps, and the
+		// leapfrog only kicks them with the pull from outside their group. Fragments that still ignore
+		// each other are left out, since their mutual pull does not count.
+		if (config.encounter_subcycling && !block_timesteps && config.gravity_enabled)
+		{
+			encounter_excluded.resize(n_bodies);
+			for (int k = 0; k < n_bodies; ++k)
+				encounter_excluded[k] = s.family[k] >= 0;
+			EncounterSubcycling::findGroups(s, timestep, encounter_excluded, encounter_groups, encounter_sets, frame_arena.resource());
+		}
+		else
+			encounter_groups.clear();
+		const int n_groups = static_cast<int>(encounter_groups.size());
+
+		std::pmr::vector<char> in_group(n_groups > 0 ? n_bodies : 0, 0, frame_arena.resource());
+		for (const auto& group : encounter_groups)
+			for (const int k : group)
+				in_group[k] = 1;
+
+		// Adds sign times the pull within each group to the members' acceleration
+		const auto add_group_pull = [&](double sign) {
+			group_pull.reset();
+			TaskPool::global().parallelFor(0, n_groups, 1, [&](int g) {
+				const auto& group = encounter_groups[g];
+				std::vector<double>& pull = group_pull.local();
+				pull.resize(2 * group.size());
+				double* ax = pull.data();
+				double* ay = ax + group.size();
+				EncounterSubcycling::groupAcceleration(s, group, ax, ay);
+				for (size_t a = 0; a < group.size(); ++a)
 				{
-					#pragma omp critical(events)
-					roche_events.push_back({i});
-					break; 
+					s.ax[group[a]] += sign * ax[a];
+					s.ay[group[a]] += sign * ay[a];
 				}
+			});
+		};
+		add_group_pull(-1.0);
 
-				// Collision
-				if (dist < rad_dist)
+		for (int sub = 0; sub < n_substeps; ++sub)
+		{
+			// --- PHASE 1: OPENING KICK + DRIFT ---
+			// Bodies starting a step get the first half kick, everything drifts so positions stay current
+			TaskPool::global().parallelFor(0, n_bodies, tuning.schedule(ParallelLoop::BODY_UPDATE), [&](int k) {
+				const int step = step_of(k);
+				if (config.gravity_enabled && sub % step == 0)
 				{
-					// Compact remnants always absorb less dense objects
-					auto compactness = [](BodyType t) {
-						if (t == BLACKHOLE)    return 3;
-						if (t == NEUTRONSTAR)  return 2;
-						if (t == WHITEDWARF)   return 1;
-						return 0;
-					};
-					const int ci = compactness(hot_planets[i].type);
-					const int cj = compactness(hot_planets[j].type);
-
-					if (ci < cj || (ci == cj && mi <= hot_planets[j].mass))
-					{
-						#pragma omp critical(events)
-						collision_events.push_back({i, static_cast<int>(j)});
-						break; // Planet i is absorbed
-					}
+					s.vx[k] += s.ax[k] * 0.5 * step * sub_dt;
+					s.vy[k] += s.ay[k] * 0.5 * step * sub_dt;
+					s.step_ax[k] = s.ax[k];
+					s.step_ay[k] = s.ay[k];
+				}
+				if (n_groups > 0 && in_group[k]) return;
+				s.x[k] += s.vx[k] * sub_dt;
+				s.y[k] += s.vy[k] * sub_dt;
+			});
+
+			// Group members drift under their mutual pull instead
+			std::atomic<size_t> substeps{ 0 };
+			TaskPool::global().parallelFor(0, n_groups, 1, [&](int g) {
+				substeps.fetch_add(EncounterSubcycling::advance(s, encounter_groups[g], sub_dt), std::memory_order_relaxed);
+			});
+			encounter_substeps += substeps.load();
+
+			// Bodies whose step ends with this substep, all of them on the last one
+			active_slots.clear();
+			for (int k = 0; k < n_bodies; ++k)
+				if ((sub + 1) % step_of(k) == 0)
+					active_slots.push_back(k);
+			force_evaluations += active_slots.size();
+
+			// --- PHASE 2: BIG UNIFIED PASS (Gravity, Heat, Collisions, Roche) ---
+			force_pass(active_slots, (sub + 1) * sub_dt);
+
+			// --- PHASE 3: SECOND KICK ---
+			add_group_pull(-1.0);
+			const int n_active = static_cast<int>(active_slots.size());
+			const bool last_substep = sub + 1 == n_substeps;
+
+			TaskPool::global().parallelFor(0, n_active, tuning.schedule(ParallelLoop::BODY_UPDATE), [&](int t) {
+				const int k = active_slots[t];
+				const int step = step_of(k);
+				if (config.gravity_enabled) {
+					s.vx[k] += s.ax[k] * 0.5 * step * sub_dt;
+					s.vy[k] += s.ay[k] * 0.5 * step * sub_dt;
 				}
-			}
 
-			accelerations[i].x = static_cast<float>(ax);
-			accelerations[i].y = static_cast<float>(ay);
-			hot_planets[i].strongestAttractorMag = max_force;
-			hot_planets[i].strongestAttractorId = max_id;
-			hot_planets[i].accumulatedHeat = total_heat;
+				// Bodies may refine at any step end but only coarsen where the coarser step also ends
+				if (block_timesteps && !last_substep)
+					s.rung[k] = BlockTimesteps::alignedRung(wanted_rung(k), s.rung[k], top_rung, sub);
+			});
+
+			// The stored acceleration stays the full pull, for the next tick and the write back
+			add_group_pull(1.0);
 		}
 	}
 
-	// --- PHASE 3: SECOND KICK + SYNC ---
-	#pragma omp parallel for if(n_planets > 50)
-	for (int i = 0; i < static_cast<int>(n_planets); ++i)
+	// Heat at the end-of-tick positions, from the emitters only: O(N * E) rather than a term of every pair
+	if (config.heat_enabled)
 	{
-		if (planets[i].isMarkedForRemoval()) continue;
-		
-		if (config.gravity_enabled) {
-			sf::Vector2f vel = planets[i].getVelocity();
-			vel.x += accelerations[i].x * half_dt;
-			vel.y += accelerations[i].y * half_dt;
-			planets[i].setVelocity(vel);
-		}
-		
-		planets[i].setAcceleration(accelerations[i]);
-		planets[i].setStrongestAttractorStrength(hot_planets[i].strongestAttractorMag);
-		planets[i].setStrongestAttractorIdRef(hot_planets[i].strongestAttractorId);
+		heat_emitters.clear();
+		for (int k = 0; k < n_bodies; ++k)
+			if (s.heat[k] > 0.0)
+				heat_emitters.add(s.x[k], s.y[k], s.heat[k], s.id[k], k);
+		heat_emitters.accumulate(s.x.data(), s.y.data(), n_bodies, s.heat_in.data());
+		heat_emitters_stale = true;
+
+		TaskPool::global().parallelFor(0, n_bodies, tuning.schedule(ParallelLoop::BODY_UPDATE), [&](int k) {
+			// Pairs within a family give no heat either, the few bodies in one are summed again without their family
+			if (s.family[k] >= 0)
+			{
+				s.heat_in[k] = 0.0;
+				for (const auto& e : heat_emitters.all())
+					if (e.slot != k && s.family[e.slot] != s.family[k])
+						s.heat_in[k] += e.output / std::max(std::hypot(e.x - s.x[k], e.y - s.y[k]), 1.0);
+			}
+			s.heat_in[k] *= tempConstTwo * s.radius[k] * s.radius[k];
+		});
+	}
+
+	// --- SYNC ---
+	TaskPool::global().parallelFor(0, n_bodies, tuning.schedule(ParallelLoop::BODY_UPDATE), [&](int k) {
+		Planet& planet = planets[s.planet[k]];
+		planet.setPosition(sf::Vector2f(static_cast<float>(s.x[k]), static_cast<float>(s.y[k])));
+		planet.setVelocity(sf::Vector2f(static_cast<float>(s.vx[k]), static_cast<float>(s.vy[k])));
+		planet.setAcceleration(sf::Vector2f(static_cast<float>(s.ax[k]), static_cast<float>(s.ay[k])));
+		planet.setStrongestAttractorStrength(s.strongest_force[k]);
+		planet.setStrongestAttractorIdRef(s.strongest_slot[k] >= 0 ? s.id[s.strongest_slot[k]] : -1);
+		s.rung[k] = block_timesteps ? wanted_rung(k) : -1;
+		planet.setTimeRung(s.rung[k]);
+		if (integrator != Integrator::HERMITE4)
+			s.jx[k] = s.jy[k] = 0.0;
+		planet.setJerk(sf::Vector2f(static_cast<float>(s.jx[k]), static_cast<float>(s.jy[k])));
 		
 		if (config.heat_enabled) {
-			planets[i].absorbHeat(hot_planets[i].accumulatedHeat * timestep, static_cast<int>(timestep));
+			planet.absorbHeat(s.heat_in[k] * timestep, static_cast<int>(timestep));
 		}
 
-		if (planets[i].disintegrationGraceTimeOver(curr_time))
-			planets[i].clearIgnores();
+		if (planet.disintegrationGraceTimeOver(curr_time))
+			planet.leaveFamily();
+	});
+
+	// Totals from the end-of-tick state, with the potential energy from the accelerations of the last force
+	// pass, around last tick's centre of mass to keep the products small. Queued planets have no slot yet.
+	{
+		const double ref_x = aggregates.centerX();
+		const double ref_y = aggregates.centerY();
+		SystemAggregates totals;
+		for (int k = 0; k < n_bodies; ++k)
+			totals.add(s.mass[k], s.x[k], s.y[k], s.vx[k], s.vy[k]);
+		for (int k = 0; k < s.sources(); ++k)
+			totals.potential += s.mass[k] * ((s.x[k] - ref_x) * s.ax[k] + (s.y[k] - ref_y) * s.ay[k]);
+		for (const auto& p : pending_planets)
+			totals.add(p);
+		aggregates = totals;
 	}
 
 	// --- PHASE 4: PROCESS EVENTS (Serial) ---
-	// Sort events by index to avoid duplicate processing if multiple things happened to same planet
-	// Though Roche and Collision both mark for removal, so findPlanetPtr check is enough.
+	// Events are handled in the order they happened within the tick, ties by index so the outcome does not
+	// depend on the threads' recording order. Roche and Collision both mark for removal, so a planet is
+	// only consumed by its earliest event.
+	collision_buffers.gather(collision_events);
+	roche_buffers.gather(roche_events);
+	std::sort(roche_events.begin(), roche_events.end(), [](const RocheEvent& a, const RocheEvent& b) {
+		return a.time != b.time ? a.time < b.time : a.planet_idx < b.planet_idx;
+	});
+	std::sort(collision_events.begin(), collision_events.end(), [](const CollisionEvent& a, const CollisionEvent& b) {
+		return a.time != b.time ? a.time < b.time : a.planetA_idx < b.planetA_idx;
+	});
 
 	for (const auto& ev : roche_events) {
 		if (ev.planet_idx < (int)planets.size() && !planets[ev.planet_idx].isMarkedForRemoval()) {
-			disintegratePlanet(planets[ev.planet_idx]);
+			disintegratePlanet(planets[ev.planet_idx].getId());
 		}
 	}
 
-	// Resolve collision chains: if A->B and B->C, then A should be absorbed by C
-	std::unordered_map<int, int> absorbed_by;
-	for (const auto& ev : collision_events) {
-		absorbed_by[ev.planetA_idx] = ev.planetB_idx;
-	}
+	// Merge groups: each collision joins the absorbed planet to its absorber, so chains like A->B->C end up in
+	// one group, absorbed by the member that is not absorbed itself. Equal bodies can absorb each other in a
+	// cycle that leaves no such member, then the heaviest of the group, lowest index on ties, is kept.
+	if (!collision_events.empty())
+	{
+		const int n_planets = static_cast<int>(planets.size());
+		merge_groups.reset(n_planets);
+		merge_absorbed.assign(n_planets, 0);
+		merge_absorber.assign(n_planets, -1);
+		for (const auto& ev : collision_events) {
+			merge_groups.unite(ev.planetA_idx, ev.planetB_idx);
+			merge_absorbed[ev.planetA_idx] = 1;
+		}
 
-	// Break cycles: if A->B and B->A, keep the lower index as absorber
-	for (auto it = absorbed_by.begin(); it != absorbed_by.end(); ) {
-		int a = it->first;
-		int b = it->second;
-		if (absorbed_by.count(b) && absorbed_by[b] == a) {
-			// Mutual absorption — break cycle by removing the higher index from the map
-			if (a > b)
-				it = absorbed_by.erase(it);
-			else {
-				absorbed_by.erase(b);
-				++it;
+		const auto better_absorber = [&](int k, int current) {
+			if (current < 0) return true;
+			if (merge_absorbed[k] != merge_absorbed[current]) return !merge_absorbed[k];
+			if (planets[k].getMass() != planets[current].getMass()) return planets[k].getMass() > planets[current].getMass();
+			return k < current;
+		};
+		for (const auto& ev : collision_events) {
+			for (const int k : { ev.planetA_idx, ev.planetB_idx }) {
+				int& absorber = merge_absorber[merge_groups.find(k)];
+				if (better_absorber(k, absorber))
+					absorber = k;
 			}
-		} else {
-			++it;
 		}
-	}
-
-	auto find_ultimate_absorber = [&](int idx) -> int {
-		int steps = 0;
-		while (absorbed_by.count(idx) && steps++ < 100)
-			idx = absorbed_by[idx];
-		return idx;
-	};
-
-	// Group by ultimate absorber to process all at once
-	std::unordered_map<int, std::vector<int>> absorption_groups;
-	for (const auto& [absorbed_idx, _] : absorbed_by) {
-		int ultimate = find_ultimate_absorber(absorbed_idx);
-		absorption_groups[ultimate].push_back(absorbed_idx);
-	}
-
-	for (const auto& [absorber_idx, absorbed_list] : absorption_groups) {
-		if (absorber_idx >= (int)planets.size() || planets[absorber_idx].isMarkedForRemoval())
-			continue;
 
-		for (int absorbed_idx : absorbed_list) {
-			if (absorbed_idx >= (int)planets.size() || planets[absorbed_idx].isMarkedForRemoval())
+		// In the order the collisions happened
+		for (const auto& ev : collision_events) {
+			const int absorbed_idx = ev.planetA_idx;
+			const int absorber_idx = merge_absorber[merge_groups.find(absorbed_idx)];
+			if (absorbed_idx == absorber_idx || planets[absorber_idx].isMarkedForRemoval() || planets[absorbed_idx].isMarkedForRemoval())
 				continue;
 
 			Planet& pA = planets[absorbed_idx];
@@ -398,7 +1084,21 @@ void Space::update()
 			const auto collision_radius = static_cast<float>(pA.getRadius());
 			const auto collision_temp = pA.getTemp();
 
+			// Mass and momentum carry over, the absorber's position and the kinetic energy do not.
+			// The absorber's stored velocity takes the same mass-weighted mean in double.
+			const double mA = pA.getMass();
+			const double mB = pB.getMass();
+			const int a = bodySlot(pA.getId());
+			const int b = bodySlot(pB.getId());
+			aggregates.remove(pA);
+			aggregates.remove(pB);
 			pA.becomeAbsorbedBy(pB);
+			if (a >= 0 && b >= 0) {
+				s.vx[b] = (mB * s.vx[b] + mA * s.vx[a]) / (mA + mB);
+				s.vy[b] = (mB * s.vy[b] + mA * s.vy[a]) / (mA + mB);
+				pB.setVelocity(sf::Vector2f(static_cast<float>(s.vx[b]), static_cast<float>(s.vy[b])));
+			}
+			aggregates.add(pB);
 
 			addExplosion(collision_pos,
 						4 * collision_radius,
@@ -426,15 +1126,25 @@ void Space::update()
 		}
 	}
 
-	std::erase_if(planets, [](const Planet & planet) { return planet.isMarkedForRemoval(); });
-	
-	// Update fuel burn rate from slider (0-50 maps to 0.0-5.0x)
-	config.fuel_burn_rate = fuelBurnSlider->getValue() / 10.0;
+	// Removed planets free their ids, the others move up and their slots follow
+	size_t kept = 0;
+	for (size_t k = 0; k < planets.size(); ++k)
 	{
-		std::stringstream ss;
-		ss << std::fixed << std::setprecision(1) << config.fuel_burn_rate;
-		fuelBurnLabel->setText("Fuel burn: " + ss.str() + "x");
+		if (planets[k].isMarkedForRemoval())
+		{
+			planet_slots.erase(planets[k].getId());
+			if (!planet_names.empty())
+				planet_names.erase(planets[k].getId());
+			continue;
+		}
+		if (kept != k)
+		{
+			planets[kept] = std::move(planets[k]);
+			planet_slots.find(planets[kept].getId())->index = static_cast<int>(kept);
+		}
+		++kept;
 	}
+	planets.erase(planets.begin() + kept, planets.end());
 
 	for (auto & planet : planets)
 		planet.update_planet_sim(timestep, config.heat_enabled, config.fuel_burn_rate);
@@ -442,7 +1152,7 @@ void Space::update()
 	// Stellar fuel depletion — star dies, leaves remnant
 	for (auto& planet : planets)
 	{
-		if (planet.isFuelDepleted())
+		if (!planet.isMarkedForRemoval() && planet.isFuelDepleted())
 		{
 			const double mass = planet.getMass();
 			const sf::Vector2f pos = planet.getPosition();
@@ -467,12 +1177,13 @@ void Space::update()
 				remnantType = BLACKHOLE;
 			}
 
-			// Explode only the ejected mass, spawn remnant
-			Planet ejecta(planet);
-			ejecta.setMass(mass * (1.0 - remnantFraction));
-			ejecta.updateRadiAndType();
+			// The star keeps only the ejected mass and explodes in place, the remnant is spawned beside it.
+			// Removed first, so the totals give back the star's full mass.
+			removePlanet(planet.getId());
+			planet.setMass(mass * (1.0 - remnantFraction));
+			planet.updateRadiAndType();
 
-			CelestialBody remnant(mass * remnantFraction, pos.x, pos.y, vel.x, vel.y);
+			Planet remnant(mass * remnantFraction, pos.x, pos.y, vel.x, vel.y);
 			remnant.planetType = remnantType;
 			remnant.updateVisualProperties();
 			remnant.updateRadius();
@@ -484,10 +1195,7 @@ void Space::update()
 				remnant.setSubType(rollNeutronStarSubType());
 			}
 
-			explodePlanet(ejecta, &remnant);
-			removePlanet(planet.getId());
-
-			break; // planets vector modified, restart next frame
+			explodePlanet(planet.getId(), std::move(remnant));
 		}
 	}
 
@@ -527,13 +1235,16 @@ void Space::update()
 	}
 
 	flushPlanets();
-	total_mass = std::accumulate(planets.begin(), planets.end(), 0.0, [](auto v, const auto & p) {return v + p.getMass(); });
+	if (!planets.empty() && config.reorder_interval > 0 && iteration % config.reorder_interval == 0)
+		reorderObjects();
+	indexPlanets();
 
 	// MISSILE LOGIC
 	if (ship.isExist())
 	{
-		for (auto& planet : planets)
+		planet_index.queryCircle(ship.getpos().x, ship.getpos().y, MISSILE_DETECTION_RANGE, [&](const SpatialIndex::Entry& e)
 		{
+			const Planet& planet = planets[e.item];
 			if (planet.getLife().getTypeEnum() >= 6)
 			{
 				if (uniform_random(0, MISSILE_LAUNCH_COOLDOWN) == 0)
@@ -556,7 +1267,7 @@ void Space::update()
 					}
 				}
 			}
-		}
+		});
 	}
 
 	for (auto it = missiles.begin(); it != missiles.end(); )
@@ -597,20 +1308,24 @@ void Space::update()
 
 			it->pos += it->vel * static_cast<float>(timestep);
 
-			// Collision with planets
-			for (auto& planet : planets)
-			{
+			// Collision with planets, the first one in the list takes the hit
+			int hit_planet = -1;
+			planet_index.queryCircle(it->pos.x, it->pos.y, 0.0, [&](const SpatialIndex::Entry& e) {
+				if (hit_planet >= 0 && e.item > hit_planet) return;
+				const Planet& planet = planets[e.item];
 				double dx = static_cast<double>(planet.getx()) - it->pos.x;
 				double dy = static_cast<double>(planet.gety()) - it->pos.y;
 				if (dx * dx + dy * dy < planet.getRadius() * planet.getRadius())
-				{
-					destroyed = true;
-					addExplosion(it->pos, 15, planet.getVelocity(), 20);
-					
-					// Heat up the planet (arbitrary but significant energy)
-					planet.increaseThermalEnergy(COLLISION_HEAT_MULTIPLIER * 0.1); 
-					break;
-				}
+					hit_planet = e.item;
+			});
+			if (hit_planet >= 0)
+			{
+				Planet& planet = planets[hit_planet];
+				destroyed = true;
+				addExplosion(it->pos, 15, planet.getVelocity(), 20);
+				
+				// Heat up the planet (arbitrary but significant energy)
+				planet.increaseThermalEnergy(COLLISION_HEAT_MULTIPLIER * 0.1); 
 			}
 
 			// Collision with ship
@@ -830,8 +1545,11 @@ void Space::set_ambient_temperature(Planet& planet)
 
 void Space::removePlanet(const int id)
 {
-	if (Planet *planet = findPlanetPtr(id))
-		planet->markForRemoval();
+	Planet* planet = findPlanet(id);
+	if (!planet || planet->isMarkedForRemoval())
+		return;
+	aggregates.remove(*planet);
+	planet->markForRemoval();
 }
 
 void Space::removeTrail(int ind)
@@ -871,6 +1589,12 @@ void Space::full_reset(sf::View& view, const sf::RenderWindow& window)
 {
 	planets.clear();
 	pending_planets.clear();
+	planet_slots.clear();
+	body_store.clear();
+	planet_names.clear();
+	planet_index.clear();
+	aggregates = {};
+	heat_emitters_stale = true;
 	explosions.clear();
 	starshine_fades.clear();
 	particles->clear();
@@ -885,13 +1609,12 @@ void Space::full_reset(sf::View& view, const sf::RenderWindow& window)
 	click_and_drag_handler.reset();
 }
 
-std::vector<int> Space::disintegratePlanet(Planet planet)
+std::vector<int> Space::disintegratePlanet(int id)
 {
-	const auto match = std::find_if(planets.begin(), planets.end(),
-		[&planet](const auto& p) { return p.getId() == planet.getId(); });
-
-	if (match == planets.end())
+	const PlanetSlot* slot = planet_slots.find(id);
+	if (!slot || slot->pending)
 		return {};
+	const Planet& planet = planets[slot->index];
 
 	if (planet.isMainSequenceStar())
 	{
@@ -901,19 +1624,16 @@ std::vector<int> Space::disintegratePlanet(Planet planet)
 		addStarshineFade(planet.getPosition(), planet.getVelocity(), col, long_range_luminosity, short_range_luminosity, STARSHINE_FADE_LIFETIME);
 	}
 
-	if (!RocheLimit::hasMinimumBreakupSize(match->getMass()))
+	if (!RocheLimit::hasMinimumBreakupSize(planet.getMass()))
 		return {};
 
-	const auto& particles_by_rad = [planet]()
-	{
-		// Non-linear relationship: fewer particles for small bodies
-		// Base count scaled by radius^1.5 or similar
-		double rad = planet.getRadius();
-		return static_cast<size_t>(25 * rad * std::sqrt(rad));
-	};
+	// Non-linear relationship: fewer particles for small bodies
+	// Base count scaled by radius^1.5 or similar
+	const double rad = planet.getRadius();
+	const auto particles_by_rad = static_cast<size_t>(25 * rad * std::sqrt(rad));
 
 	const auto n_dust_particles = std::clamp(MAX_N_DUST_PARTICLES - particles->size(),
-		static_cast<size_t>(0), particles_by_rad());
+		static_cast<size_t>(0), particles_by_rad);
 	for (size_t i = 0; i < n_dust_particles; i++)
 	{
 		const auto scatter_pos = sf::Vector2f(planet.getPosition().x, planet.getPosition().y) + random_vector(planet.getRadius());
@@ -931,6 +1651,8 @@ std::vector<int> Space::disintegratePlanet(Planet planet)
 	const auto n_planets{ std::floor(planet.getMass() / RocheLimit::MINIMUM_BREAKUP_SIZE) };
 	const auto mass_per_planet = planet.getMass() / n_planets;
 
+	// The fragments share a family, so they ignore each other for their grace time with one compare per pair
+	const int family = next_family++;
 	std::vector<int> generated_ids;
 	for (int n = 0; n < n_planets; n++)
 	{
@@ -943,21 +1665,13 @@ std::vector<int> Space::disintegratePlanet(Planet planet)
 		p.setPosition({ p.getPosition().x + cos(angle_offset) * offset_dist, 
 						p.getPosition().y + sin(angle_offset) * offset_dist });
 		p.setTemp(uniform_random(3500.,6000.));
+		p.joinFamily(family);
+		p.setDisintegrationGraceTime(uniform_random(MIN_DT_DISINTEGRATE_GRACE_PERIOD, MAX_DT_DISINTEGRATE_GRACE_PERIOD), curr_time);
 
 		generated_ids.push_back(addPlanet(std::move(p)));
 	}
 
-	for (const auto & id : generated_ids)
-	{
-		if (Planet* p = findPlanetPtr(id))
-		{
-			for (const auto & id2 : generated_ids)
-				p->registerIgnoredId(id2);
-			p->setDisintegrationGraceTime(uniform_random(MIN_DT_DISINTEGRATE_GRACE_PERIOD, MAX_DT_DISINTEGRATE_GRACE_PERIOD), curr_time);
-		}
-	}
-
-	removePlanet(planet.getId());
+	removePlanet(id);
 
 	return generated_ids;
 }
@@ -966,7 +1680,7 @@ void Space::checkChandrasekharLimit()
 {
 	for (auto& planet : planets)
 	{
-		if (planet.planetType != WHITEDWARF || planet.getMass() <= CHANDRASEKHAR_LIMIT)
+		if (planet.isMarkedForRemoval() || planet.planetType != WHITEDWARF || planet.getMass() <= CHANDRASEKHAR_LIMIT)
 			continue;
 
 		const double mass = planet.getMass();
@@ -976,35 +1690,36 @@ void Space::checkChandrasekharLimit()
 		if (uniform_random(0, 100) < 90)
 		{
 			// Type Ia supernova — complete detonation, no remnant
-			Planet ejecta(planet);
-			ejecta.updateRadiAndType();
-			explodePlanet(ejecta);
 			removePlanet(planet.getId());
+			planet.updateRadiAndType();
+			explodePlanet(planet.getId());
 		}
 		else
 		{
 			// Accretion-induced collapse — becomes neutron star
-			Planet ejecta(planet);
-			ejecta.setMass(mass * 0.8);
-			ejecta.updateRadiAndType();
+			removePlanet(planet.getId());
+			planet.setMass(mass * 0.8);
+			planet.updateRadiAndType();
 
-			CelestialBody remnant(mass * 0.2, pos.x, pos.y, vel.x, vel.y);
+			Planet remnant(mass * 0.2, pos.x, pos.y, vel.x, vel.y);
 			remnant.planetType = NEUTRONSTAR;
 			remnant.setSubType(rollNeutronStarSubType());
 			remnant.setTemp(INITIAL_TEMP_NEUTRONSTAR);
 			remnant.updateVisualProperties();
 			remnant.updateRadius();
 
-			explodePlanet(ejecta, &remnant);
-			removePlanet(planet.getId());
+			explodePlanet(planet.getId(), std::move(remnant));
 		}
-
-		break; // planets vector modified, restart next frame
 	}
 }
 
-std::vector<int> Space::explodePlanet(Planet planet, CelestialBody* remnant)
+std::vector<int> Space::explodePlanet(int id, std::optional<Planet> remnant)
 {
+	const PlanetSlot* slot = planet_slots.find(id);
+	if (!slot || slot->pending)
+		return {};
+	const Planet& planet = planets[slot->index];
+
 	const float original_mass = planet.getMass();
 
 	const sf::Vector2f original_position = { static_cast<float>(planet.getPosition().x),
@@ -1058,36 +1773,31 @@ std::vector<int> Space::explodePlanet(Planet planet, CelestialBody* remnant)
 		addParticle(scatter_pos, scatter_vel, 2, lifespan, p_temp);
 	}
 
-	const auto fragment_ids = disintegratePlanet(planet);
-	for (auto id : fragment_ids)
+	// The fragments are the last pending planets, so they are reached without a search by id
+	const auto fragment_ids = disintegratePlanet(id);
+	const auto fragments = std::span(pending_planets).last(fragment_ids.size());
+	for (auto& fragment : fragments)
 	{
-		if (auto fragment = findPlanetPtr(id))
-		{
-			const sf::Vector2f fragment_pos = { static_cast<float>(fragment->getPosition().x),
-													static_cast<float>(fragment->getPosition().y) };
+		const sf::Vector2f fragment_pos = { static_cast<float>(fragment.getPosition().x),
+												static_cast<float>(fragment.getPosition().y) };
 
-			const sf::Vector2f to_fragment = (fragment_pos - original_position);
+		const sf::Vector2f to_fragment = (fragment_pos - original_position);
 
-			const sf::Vector2f escape_speed = EXPLODE_PLANET_SPEEDMULT_OTHER * static_cast<float>(pow(original_mass, 0.3)) * to_fragment / std::max(std::hypot(to_fragment.x, to_fragment.y), 0.1f) *	
-												static_cast<float>(uniform_random(0.85, 1.15));
+		const sf::Vector2f escape_speed = EXPLODE_PLANET_SPEEDMULT_OTHER * static_cast<float>(pow(original_mass, 0.3)) * to_fragment / std::max(std::hypot(to_fragment.x, to_fragment.y), 0.1f) *	
+											static_cast<float>(uniform_random(0.85, 1.15));
 
-			fragment->setVelocity(fragment->getVelocity() + escape_speed);
-		}
+		aggregates.remove(fragment);
+		fragment.setVelocity(fragment.getVelocity() + escape_speed);
+		aggregates.add(fragment);
 	}
 
+	// The remnant joins the fragments' family, so they leave it without being pulled back or swallowed
 	if (remnant)
 	{
-		int remnantId = addPlanet(std::move(*remnant));
-		if (auto* r = findPlanetPtr(remnantId))
-		{
-			for (int fid : fragment_ids)
-			{
-				r->registerIgnoredId(fid);
-				if (auto* f = findPlanetPtr(fid))
-					f->registerIgnoredId(remnantId);
-			}
-			r->setDisintegrationGraceTime(500, curr_time);
-		}
+		if (!fragments.empty())
+			remnant->joinFamily(fragments.front().getFamily());
+		remnant->setDisintegrationGraceTime(500, curr_time);
+		addPlanet(std::move(*remnant));
 	}
 
 	return fragment_ids;
@@ -1095,38 +1805,42 @@ std::vector<int> Space::explodePlanet(Planet planet, CelestialBody* remnant)
 
 void Space::giveId(Planet &p)
 {
-	p.giveID(next_id);
-	next_id += 1;
+	// Handed out before the planet is queued, which is where it sits until the next flush
+	p.giveID(planet_slots.insert({ static_cast<int>(pending_planets.size()), true }));
 }
 
-Planet Space::findPlanet(int id)
+Planet* Space::findPlanet(int id)
 {
-	for (auto& planet : planets)
-	{
-		if (planet.getId() == id)
-			return planet;
-	}
-	for (auto& planet : pending_planets)
-	{
-		if (planet.getId() == id)
-			return planet;
-	}
-	return Planet(-1);
+	const PlanetSlot* slot = planet_slots.find(id);
+	if (!slot)
+		return nullptr;
+	return slot->pending ? &pending_planets[slot->index] : &planets[slot->index];
 }
 
-Planet* Space::findPlanetPtr(int id)
+const std::string& Space::getPlanetName(int id)
 {
-	for (auto & planet : planets)
-	{
-		if (planet.getId() == id)
-			return &planet;
-	}
-	for (auto& planet : pending_planets)
-	{
-		if (planet.getId() == id)
-			return &planet;
-	}
-	return nullptr;
+	auto name = planet_names.find(id);
+	if (name == planet_names.end())
+		name = planet_names.emplace(id, CelestialBody::generateName()).first;
+	return name->second;
+}
+
+void Space::setPlanetName(int id, const std::string& name)
+{
+	planet_names[id] = name;
+}
+
+Planet* Space::planetAt(sf::Vector2f pos)
+{
+	// The first planet in the list wins where several overlap
+	int best = -1;
+	planet_index.queryCircle(pos.x, pos.y, 0.0, [&](const SpatialIndex::Entry& e) {
+		if (e.item >= static_cast<int>(planets.size()) || (best >= 0 && e.item > best)) return;
+		const Planet& planet = planets[e.item];
+		if (std::hypot(planet.getx() - pos.x, planet.gety() - pos.y) < planet.getRadius())
+			best = e.item;
+	});
+	return best >= 0 ? &planets[best] : nullptr;
 }
 
 int Space::findBestPlanetByRef(const Planet& query_planet)
@@ -1236,10 +1950,24 @@ void Space::update_spaceship()
 		addParticle(p, v, uniform_random(1.3, 1.5), uniform_random(300.0, 500.0));
 	}
 
-	for (const auto & planet : planets)
+	if (ship.isExist())
 	{
-		if (ship.isExist() && !ship.pullofGravity(planet, ship, timestep, config.gravity_enabled))
+		// Only planets whose disc holds the ship can destroy it, gravity comes from all of them
+		bool crashed = false;
+		planet_index.queryCircle(ship.getpos().x, ship.getpos().y, 0.0, [&](const SpatialIndex::Entry& e) {
+			crashed = crashed || (e.item < static_cast<int>(planets.size()) && ship.isInside(planets[e.item]));
+		});
+
+		if (crashed)
+		{
+			ship.destroy();
 			addExplosion(ship.getpos(), 10, sf::Vector2f(0, 0), 10);
+		}
+		else if (config.gravity_enabled)
+		{
+			for (const auto& planet : planets)
+				ship.pullofGravity(planet, timestep);
+		}
 	}
 
     if (ship.isExist())
@@ -1261,7 +1989,7 @@ void Space::updateInfoBox()
 	zoomStr << std::fixed << std::setprecision(1) << (1.0 / click_and_drag_handler.get_zoom());
 
 	simInfo->setText("Frame rate: " + std::to_string(fps) +
-		"\nTotal mass: " + std::to_string(static_cast<int>(total_mass)) +
+		"\nTotal mass: " + std::to_string(static_cast<int>(aggregates.mass)) +
 		"\nObjects: " + std::to_string(planets.size()) +
 		"\nParticles: " + std::to_string(particles->size()) +
 		"\nZoom: " + zoomStr.str());
@@ -1480,6 +2208,13 @@ void Space::initSetup()
 	fuelBurnSlider->setMaximum(250);
 	fuelBurnSlider->setValue(10);
 	config.fuel_burn_rate = 1.0;
+	// Slider 0-250 maps to 0.0-25.0x
+	fuelBurnSlider->onValueChange([this](float value) {
+		config.fuel_burn_rate = value / 10.0;
+		std::stringstream ss;
+		ss << std::fixed << std::setprecision(1) << config.fuel_burn_rate;
+		fuelBurnLabel->setText("Fuel burn: " + ss.str() + "x");
+	});
 	optionsMenu->add(fuelBurnSlider);
 
 	bloomCheckBox->setPosition(10, 150);
@@ -1568,14 +2303,15 @@ double Space::convertStringToDouble(std::string string)
 	return result;
 }
 
-void Space::renderMST(sf::RenderTarget& window, const std::vector<size_t>& members)
+void Space::renderMST(sf::RenderTarget& window, std::span<const size_t> members)
 {
 	if (members.size() < 2u) return;
 
 	// Prim's algorithm for MST
-	std::vector<bool> inMST(members.size(), false);
-	std::vector<double> minEdge(members.size(), std::numeric_limits<double>::max());
-	std::vector<int> parent(members.size(), -1);
+	std::pmr::memory_resource* scratch = frame_arena.resource();
+	std::pmr::vector<char> inMST(members.size(), false, scratch);
+	std::pmr::vector<double> minEdge(members.size(), std::numeric_limits<double>::max(), scratch);
+	std::pmr::vector<int> parent(members.size(), -1, scratch);
 
 	minEdge[0] = 0;
 	for (size_t count = 0; count < members.size(); ++count)
@@ -1633,7 +2369,7 @@ void Space::drawPlanets(sf::RenderTarget &window)
 
 	if (config.render_life_always)
 	{
-		std::map<int, std::vector<size_t>> civGroups;
+		std::pmr::map<int, std::pmr::vector<size_t>> civGroups(frame_arena.resource());
 		for (size_t i = 0; i < planets.size(); i++)
 		{
 			drawLifeVisuals(window, planets[i]);
@@ -1678,7 +2414,7 @@ void Space::drawCivConnections(sf::RenderTarget& window, const Planet& p, bool d
 {
 	if (p.getLife().getTypeEnum() < 6) return;
 
-	std::vector<size_t> members;
+	std::pmr::vector<size_t> members(frame_arena.resource());
 	for (const auto& planet : planets)
 	{
 		if (planet.getLife().getId() == p.getLife().getId())
@@ -1796,16 +2532,15 @@ double Space::thermalEnergyAtPosition(sf::Vector2f pos)
 {
 	if (!config.heat_enabled) return 0.0;
 
-	double tEnergyFromOutside = 0;
-
-	for (const auto& planet : planets)
+	// Rebuilt once per tick or batch of new planets, so spawning many bodies costs O(E) each rather than O(N)
+	if (heat_emitters_stale)
 	{
-		if (planet.emitsHeat())
-		{
-			double dist = sqrt((planet.getPosition().x - pos.x)*(planet.getPosition().x - pos.x) + (planet.getPosition().y - pos.y) * (planet.getPosition().y - pos.y));
-			tEnergyFromOutside += planet.giveThermalEnergy(1)/ std::max(dist, 1.0);
-		}
+		heat_emitters.clear();
+		for (const auto& planet : planets)
+			if (planet.emitsHeat())
+				heat_emitters.add(planet.getPosition().x, planet.getPosition().y, planet.giveThermalEnergy(1), planet.getId(), -1);
+		heat_emitters_stale = false;
 	}
 
-	return tEnergyFromOutside;
+	return heat_emitters.at(pos.x, pos.y);
 }
@@ -4,7 +4,10 @@
 #include <random>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <limits>
+#include <optional>
+#include <span>
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
 #include <TGUI/TGUI.hpp>
@@ -21,6 +24,21 @@
 #include "object_tracker.h"
 #include "particles/particle_container.h"
 #include "BloomEffect.h"
+#include "physics/body_store.h"
+#include "physics/symmetric_kernel.h"
+#include "physics/mixed_kernel.h"
+#include "physics/barnes_hut.h"
+#include "physics/fmm.h"
+#include "physics/swept_contact.h"
+#include "physics/neighbour_list.h"
+#include "physics/thread_buffers.h"
+#include "physics/disjoint_sets.h"
+#include "physics/spatial_index.h"
+#include "physics/morton_order.h"
+#include "physics/heat_emitters.h"
+#include "physics/system_aggregates.h"
+#include "slot_map.h"
+#include "frame_arena.h"
 
 enum class TemperatureUnit
 {
@@ -40,8 +58,8 @@ struct Missile {
 
 class Space
 {
-	double total_mass{0.0};
-	int next_id{0};
+	SystemAggregates aggregates;	// totals of the planets in the list and the queue, less those marked for removal
+	int next_family{0};
 	float timestep{ TIMESTEP_VALUE_START };
 	double curr_time{ 0.0 };
 	int iteration{0};
@@ -51,6 +69,30 @@ class Space
 	SpaceShip ship;
 	std::vector<Planet> planets;
 	std::vector<Planet> pending_planets;
+
+	// Planet ids are handles into this map, which tracks where each planet sits in `planets` or
+	// `pending_planets` through flushes, removals and reorders, and in the body store
+	struct PlanetSlot
+	{
+		int index;
+		bool pending;
+		int body{ -1 };		// slot in body_store, -1 until the planet joins it
+	};
+	SlotMap<PlanetSlot> planet_slots;
+
+	// Names by planet id, generated the first time a planet is shown since most fragments never are
+	std::unordered_map<int, std::string> planet_names;
+
+	// Proximity index over `planets`, entries are indices into it. Rebuilt at the end of every tick, and at the
+	// start of one if planets were added since, so it stays valid until the next tick removes planets.
+	SpatialIndex planet_index;
+	std::vector<SpatialIndex::Entry> planet_index_entries;
+	void indexPlanets();
+
+	// Keeps planets that are close in space close in `planets`, see SimConfig::reorder_interval
+	MortonOrder planet_order;
+	std::vector<Planet> reorder_scratch;
+	void reorderObjects();
 	std::unique_ptr<IParticleContainer> particles;
 	std::vector<Explosion> explosions;
 	std::vector<StarshineFade> starshine_fades;
@@ -58,32 +100,63 @@ class Space
 	std::vector<Missile> missiles;
 	Bound bound;
 	
-	struct HotPlanet
-	{
-		float x, y;
-		double mass;
-		double radius;
-		int id;
-		BodyType type;
-		double strongestAttractorMag;
-		int strongestAttractorId;
-		double accumulatedHeat;
-		double thermalEnergyOutput;
-		double g_mass;
-		double radius_sq;
-	};
-	std::vector<HotPlanet> hot_planets;
-	std::vector<sf::Vector2f> accelerations;
+	// Owns the motion of the planets between ticks, see BodyStore. Planets that joined it are edited through
+	// setPlanetMotion(), since their own position and velocity are overwritten from it every tick.
+	BodyStore body_store;
+	BodyStore body_scratch;
+	void syncBodyStore();
+	int bodySlot(int id) const;
+	std::vector<int> active_slots;
+	size_t force_evaluations{ 0 };
+	std::vector<std::vector<int>> encounter_groups;
+	std::vector<char> encounter_excluded;
+	DisjointSets encounter_sets;
+	ThreadBuffers<double> group_pull;	// pull within one encounter group, x then y
+	size_t encounter_substeps{ 0 };
+
+	SymmetricPairKernel symmetric_kernel;
+	MixedPairKernel mixed_kernel;
+	std::vector<PairKernel::Sums> pair_sums;
+
+	BarnesHutTree barnes_hut;
+	FmmSolver fmm;
+	std::vector<TreeBody> tree_bodies;
+	void gatherTreeBodies();
+	SweptPaths swept_paths;
+	NeighbourList neighbour_list;
+	std::vector<int> pass_slots;		// bodies a partial substep pass refreshes, see Space::update()
+	std::vector<char> in_pass_slots;
+
+	// Heat sources among the bodies. Filled from the body store for the heat of each tick, and from `planets`
+	// for thermalEnergyAtPosition() once stale, i.e. after a tick, new planets or a reset.
+	HeatEmitters heat_emitters;
+	bool heat_emitters_stale{ true };
 
 	struct CollisionEvent {
 		int planetA_idx;
 		int planetB_idx;
+		double time;	// since the start of the tick
 	};
 
 	struct RocheEvent {
 		int planet_idx;
+		double time;
 	};
 
+	// Events of the force passes, recorded per thread without locks and gathered for resolution
+	ThreadBuffers<CollisionEvent> collision_buffers;
+	ThreadBuffers<RocheEvent> roche_buffers;
+	std::vector<CollisionEvent> collision_events;
+	std::vector<RocheEvent> roche_events;
+
+	// Merge groups of the tick's collisions, per planet index
+	DisjointSets merge_groups;
+	std::vector<char> merge_absorbed;
+	std::vector<int> merge_absorber;	// absorber of each group, kept at the group's root
+
+	// Scratch of the main thread, reset at the start of every tick and frame
+	FrameArena frame_arena;
+
 	tgui::TextArea::Ptr simInfo = std::make_shared<tgui::TextArea>();
 	tgui::Label::Ptr toolInfo = std::make_shared<tgui::Label>();
 	tgui::TextArea::Ptr newPlanetInfo = std::make_shared<tgui::TextArea>();
@@ -113,7 +186,7 @@ class Space
 	ObjectTracker object_tracker;
 	ObjectInfo object_info;
 
-	void renderMST(sf::RenderTarget& window, const std::vector<size_t>& members);
+	void renderMST(sf::RenderTarget& window, std::span<const size_t> members);
 
 public:
 
@@ -128,8 +201,13 @@ public:
 	void removeTrail(int ind);
 	void full_reset(sf::View& view, const sf::RenderWindow & window);
 
-	std::vector<int> disintegratePlanet(Planet planet);	/* No reference due to addition of new planets possibly invalidating references */
-	std::vector<int> explodePlanet(Planet planet, CelestialBody* remnant = nullptr);	/* No reference due to addition of new planets possibly invalidating references */
+	/*
+	 * Both take the id of a planet in the list and read it in place: the fragments and the remnant go to
+	 * pending_planets until the next flush, so the list does not move under them. The planet is marked for
+	 * removal and stays readable until the next sweep. Return the ids of the fragments.
+	 */
+	std::vector<int> disintegratePlanet(int id);
+	std::vector<int> explodePlanet(int id, std::optional<Planet> remnant = std::nullopt);
 	void checkChandrasekharLimit();
 
 	void randomPlanets(int totmass, int antall, double radius, sf::Vector2f pos);
@@ -151,8 +229,18 @@ public:
 	void drawMissiles(sf::RenderTarget& window);
 	void drawDust(sf::RenderTarget &window);
 	void giveId(Planet &p);
-	Planet findPlanet(int id);
-	Planet* findPlanetPtr(int id);
+	Planet* findPlanet(int id);
+
+	// Position and velocity of a planet, in double from the body store once the planet is in it
+	struct PlanetMotion
+	{
+		double x, y, vx, vy;
+	};
+	std::optional<PlanetMotion> getPlanetMotion(int id);
+	bool setPlanetMotion(int id, const PlanetMotion& motion);
+	const std::string& getPlanetName(int id);
+	void setPlanetName(int id, const std::string& name);
+	Planet* planetAt(sf::Vector2f pos);
 	int findBestPlanetByRef(const Planet& query_planet);
 	void update_spaceship();
 	double thermalEnergyAtPosition(sf::Vector2f pos);
@@ -160,8 +248,17 @@ public:
 	sf::Vector2f centerOfMassVelocity(const std::vector<int> & object_ids);
 	sf::Vector2f centerOfMassAll();
 	int get_iteration() const;
+	size_t getForceEvaluations() const { return force_evaluations; }
+	size_t getEncounterSubsteps() const { return encounter_substeps; }
+	size_t getNeighbourListRebuilds() const { return neighbour_list.rebuilds(); }
+	size_t getReorderSorts() const { return planet_order.sorts(); }
+	int getPassiveBodies() const { return body_store.size() - body_store.sources(); }
+	void setTimestep(float t) { timestep = t; }
+	float getTimestep() const { return timestep; }
 	bool auto_bound_active() const;
 	const std::vector<Planet>& getPlanets() const { return planets; }
+	const SystemAggregates& getAggregates() const { return aggregates; }
+	FrameArena& frameArena() { return frame_arena; }
 	void syncConfigToWidgets();
 
 	SimConfig config;
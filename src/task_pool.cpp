@@ -0,0 +1,179 @@
+#include "task_pool.h"
+
+thread_local int TaskPool::worker_index = 0;
+thread_local bool TaskPool::in_chunk = false;
+
+namespace {
+
+// Failed steal attempts before a worker goes to sleep, so back-to-back passes of a tick find it awake
+constexpr int SPINS_BEFORE_SLEEP = 256;
+
+int hardwareThreads()
+{
+	return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+}
+
+int TaskPool::maxThreads() noexcept
+{
+	return 4 * hardwareThreads();
+}
+
+TaskPool& TaskPool::global()
+{
+	static TaskPool pool;
+	return pool;
+}
+
+TaskPool::TaskPool(int threads)
+{
+	start(threads);
+}
+
+TaskPool::~TaskPool()
+{
+	stop();
+}
+
+void TaskPool::setThreadCount(int threads)
+{
+	if (std::min(threads > 0 ? threads : hardwareThreads(), maxThreads()) == threadCount())
+		return;
+	stop();
+	start(threads);
+}
+
+void TaskPool::start(int threads)
+{
+	if (threads <= 0)
+		threads = hardwareThreads();
+	threads = std::min(threads, maxThreads());
+
+	stopping = false;
+	queues.clear();
+	for (int k = 0; k < threads; ++k)
+		queues.push_back(std::make_unique<Queue>());
+	for (int k = 1; k < threads; ++k)
+		workers.emplace_back([this, k] { workerLoop(k); });
+}
+
+void TaskPool::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& worker : workers)
+		worker.join();
+	workers.clear();
+}
+
+void TaskPool::run(Job& job, int begin, int end, int grain)
+{
+	std::lock_guard<std::mutex> submit(submit_mutex);
+	const int n_chunks = (end - begin + grain - 1) / grain;
+	const int threads = threadCount();
+	job.begin = begin;
+	job.end = end;
+	job.grain = grain;
+	job.pending.store(n_chunks, std::memory_order_relaxed);
+
+	// Round-robin, so neighbouring chunks start on different threads
+	for (int t = 0; t < threads; ++t)
+	{
+		Queue& queue = *queues[t];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.job = &job;
+		queue.next = 0;
+		queue.last = t < n_chunks ? (n_chunks - t + threads - 1) / threads : 0;
+	}
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		queued.fetch_add(n_chunks, std::memory_order_relaxed);
+	}
+	wake.notify_all();
+
+	// The calling thread works as worker 0 until the last chunk, its own or stolen, has finished
+	while (job.pending.load(std::memory_order_acquire) > 0)
+		if (!runOne(0))
+			std::this_thread::yield();
+
+	if (job.error)
+		std::rethrow_exception(job.error);
+}
+
+bool TaskPool::runOne(int self)
+{
+	const int threads = threadCount();
+	Job* job = nullptr;
+	int chunk = 0;
+
+	{
+		Queue& own = *queues[self];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (own.next < own.last)
+		{
+			job = own.job;
+			chunk = self + --own.last * threads;
+		}
+	}
+	for (int k = 1; !job && k < threads; ++k)
+	{
+		const int victim_index = (self + k) % threads;
+		Queue& victim = *queues[victim_index];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (victim.next < victim.last)
+		{
+			job = victim.job;
+			chunk = victim_index + victim.next++ * threads;
+		}
+	}
+	if (!job)
+		return false;
+
+	queued.fetch_sub(1, std::memory_order_relaxed);
+	const int chunk_begin = job->begin + chunk * job->grain;
+	in_chunk = true;
+	try
+	{
+		job->run(job->context, chunk_begin, std::min(chunk_begin + job->grain, job->end));
+	}
+	catch (...)
+	{
+		// Counted as done like any other chunk, the owner rethrows it once the job is over
+		if (!job->failed.exchange(true, std::memory_order_relaxed))
+			job->error = std::current_exception();
+	}
+	in_chunk = false;
+
+	// Last touch of the job, its owner may return as soon as the count reaches zero
+	job->pending.fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+void TaskPool::workerLoop(int self)
+{
+	worker_index = self;
+	int idle_spins = 0;
+	for (;;)
+	{
+		if (runOne(self))
+		{
+			idle_spins = 0;
+			continue;
+		}
+		if (++idle_spins < SPINS_BEFORE_SLEEP)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_relaxed) > 0; });
+		if (stopping)
+			return;
+		idle_spins = 0;
+	}
+}
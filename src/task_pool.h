@@ -0,0 +1,162 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Persistent worker pool with work stealing, shared by the physics passes, the particle updates and
+ * the particle renderer.
+ *
+ * parallelFor() cuts a range into chunks and deals them round-robin to the workers. A worker's share
+ * is a run of chunk numbers in its queue: it takes chunks from the back of its own run and, once that is
+ * empty, steals from the front of the others', so uneven chunks (tree walks, fragment families) balance
+ * out. The queues only hold the bounds of the runs, so a call allocates nothing. The calling thread
+ * works as worker 0 until every chunk is done. Workers sleep between calls, so an idle simulation costs
+ * nothing, and the threads are kept for the life of the pool.
+ *
+ * A parallelFor() issued from inside a chunk runs inline on the calling worker.
+ */
+class TaskPool
+{
+public:
+	// Pool of the whole program, sized by SimConfig::worker_threads
+	static TaskPool& global();
+
+	explicit TaskPool(int threads = 0);
+	~TaskPool();
+
+	TaskPool(const TaskPool&) = delete;
+	TaskPool& operator=(const TaskPool&) = delete;
+
+	/*
+	 * Number of threads that run chunks, the calling thread included. 0 picks the hardware concurrency,
+	 * and counts above maxThreads() are clamped to it. Must not be called while a parallelFor() is running.
+	 */
+	void setThreadCount(int threads);
+	[[nodiscard]] int threadCount() const noexcept { return static_cast<int>(queues.size()); }
+
+	// Four times the hardware concurrency
+	[[nodiscard]] static int maxThreads() noexcept;
+
+	// Index of the calling thread in [0, threadCount()): 0 for the thread that issues the calls
+	[[nodiscard]] static int workerIndex() noexcept { return worker_index; }
+
+	/*
+	 * Calls fn(i) for every i in [begin, end), in chunks of `grain` iterations. Ranges of a single chunk,
+	 * and all ranges on a pool of one thread, run inline without touching the workers.
+	 */
+	template <typename Fn>
+	void parallelFor(int begin, int end, int grain, Fn&& fn)
+	{
+		parallelChunks(begin, end, grain, [&fn](int chunk_begin, int chunk_end) {
+			for (int i = chunk_begin; i < chunk_end; ++i)
+				fn(i);
+		});
+	}
+
+	// Same with a grain that gives every thread a few chunks, for loops of even cost per iteration
+	template <typename Fn>
+	void parallelFor(int begin, int end, Fn&& fn)
+	{
+		parallelFor(begin, end, autoGrain(end - begin), std::forward<Fn>(fn));
+	}
+
+	// When a loop goes parallel and how it is chunked, see ParallelTuning
+	struct Schedule
+	{
+		int min_parallel;	// fewer iterations run serially on the calling thread
+		int grain;			// iterations per chunk, 0 for the automatic grain
+
+		// The same schedule for a loop over blocks of `block` iterations each
+		[[nodiscard]] Schedule perBlock(int block) const noexcept
+		{
+			return { min_parallel / block + (min_parallel % block != 0), grain > 0 ? std::max(grain / block, 1) : 0 };
+		}
+	};
+
+	template <typename Fn>
+	void parallelFor(int begin, int end, const Schedule& schedule, Fn&& fn)
+	{
+		if (end - begin < schedule.min_parallel)
+		{
+			for (int i = begin; i < end; ++i)
+				fn(i);
+			return;
+		}
+		parallelFor(begin, end, schedule.grain > 0 ? schedule.grain : autoGrain(end - begin), std::forward<Fn>(fn));
+	}
+
+	/*
+	 * Calls fn(chunk_begin, chunk_end) for consecutive chunks of `grain` iterations covering [begin, end).
+	 * If a chunk throws, the other chunks still run and the first exception is rethrown on the calling thread.
+	 */
+	template <typename Fn>
+	void parallelChunks(int begin, int end, int grain, Fn&& fn)
+	{
+		grain = std::max(grain, 1);
+		if (end - begin <= grain || threadCount() == 1 || in_chunk)
+		{
+			if (begin < end)
+				fn(begin, end);
+			return;
+		}
+
+		using Body = std::remove_reference_t<Fn>;
+		Job job;
+		job.run = [](void* context, int chunk_begin, int chunk_end) { (*static_cast<Body*>(context))(chunk_begin, chunk_end); };
+		job.context = const_cast<void*>(static_cast<const void*>(&fn));
+		run(job, begin, end, grain);
+	}
+
+	// Minimum chunk of parallelFor() without a grain
+	static constexpr int MIN_AUTO_GRAIN = 64;
+
+	// Grain of parallelFor() without one: a few chunks per thread
+	[[nodiscard]] int autoGrain(int n) const noexcept { return std::max(n / (4 * threadCount()), MIN_AUTO_GRAIN); }
+
+private:
+	struct Job
+	{
+		void (*run)(void*, int, int) = nullptr;
+		void* context = nullptr;
+		int begin = 0, end = 0, grain = 1;
+		std::atomic<int> pending{ 0 };
+		std::atomic<bool> failed{ false };
+		std::exception_ptr error;		// of the first chunk that threw, read once pending is 0
+	};
+
+	// Chunks t, t + threads, t + 2 * threads, ... of the job for queue t, numbered from 0 within the queue.
+	// [next, last) are the ones not yet taken.
+	struct alignas(64) Queue
+	{
+		std::mutex mutex;
+		Job* job = nullptr;
+		int next = 0, last = 0;
+	};
+
+	void run(Job& job, int begin, int end, int grain);
+	bool runOne(int self);			// pops or steals one chunk and runs it, false if none was found
+	void workerLoop(int self);
+	void start(int threads);
+	void stop();
+
+	std::vector<std::unique_ptr<Queue>> queues;	// one per thread, queue 0 belongs to the calling thread
+	std::vector<std::thread> workers;
+	std::mutex submit_mutex;		// one job in the queues at a time
+
+	std::mutex sleep_mutex;
+	std::condition_variable wake;
+	std::atomic<int> queued{ 0 };		// chunks in the queues, not yet taken
+	bool stopping{ false };
+
+	static thread_local int worker_index;
+	static thread_local bool in_chunk;
+};
@@ -1,5 +1,6 @@
 #include "udp_server.h"
 #include "space.h"
+#include "task_pool.h"
 #include <sstream>
 #include <iostream>
 
@@ -134,6 +135,63 @@ static bool parseSubType(const std::string& name, StellarSubType& out)
     return false;
 }
 
+static std::string gravitySolverToString(GravitySolver solver)
+{
+    switch (solver)
+    {
+        case GravitySolver::DIRECT:     return "DIRECT";
+        case GravitySolver::BARNES_HUT: return "BARNES_HUT";
+        case GravitySolver::FMM:        return "FMM";
+        default:                        return "UNKNOWN";
+    }
+}
+
+static bool parseGravitySolver(const std::string& name, GravitySolver& out)
+{
+    if (name == "DIRECT")     { out = GravitySolver::DIRECT; return true; }
+    if (name == "BARNES_HUT") { out = GravitySolver::BARNES_HUT; return true; }
+    if (name == "FMM")        { out = GravitySolver::FMM; return true; }
+    return false;
+}
+
+static std::string gravityPrecisionToString(GravityPrecision precision)
+{
+    switch (precision)
+    {
+        case GravityPrecision::DOUBLE: return "DOUBLE";
+        case GravityPrecision::MIXED:  return "MIXED";
+        default:                       return "UNKNOWN";
+    }
+}
+
+static bool parseGravityPrecision(const std::string& name, GravityPrecision& out)
+{
+    if (name == "DOUBLE") { out = GravityPrecision::DOUBLE; return true; }
+    if (name == "MIXED")  { out = GravityPrecision::MIXED; return true; }
+    return false;
+}
+
+static std::string integratorToString(Integrator integrator)
+{
+    switch (integrator)
+    {
+        case Integrator::LEAPFROG:      return "LEAPFROG";
+        case Integrator::YOSHIDA4:      return "YOSHIDA4";
+        case Integrator::HERMITE4:      return "HERMITE4";
+        case Integrator::WISDOM_HOLMAN: return "WISDOM_HOLMAN";
+        default:                        return "UNKNOWN";
+    }
+}
+
+static bool parseIntegrator(const std::string& name, Integrator& out)
+{
+    if (name == "LEAPFROG")      { out = Integrator::LEAPFROG; return true; }
+    if (name == "YOSHIDA4")      { out = Integrator::YOSHIDA4; return true; }
+    if (name == "HERMITE4")      { out = Integrator::HERMITE4; return true; }
+    if (name == "WISDOM_HOLMAN") { out = Integrator::WISDOM_HOLMAN; return true; }
+    return false;
+}
+
 static sf::Keyboard::Key parseKeyName(const std::string& name)
 {
     if (name == "P") return sf::Keyboard::P;
@@ -204,7 +262,7 @@ std::string UdpCommandServer::handleCommand(const std::string& line, Space& spac
         if (!(iss >> id))
             return "ERR invalid args";
 
-        Planet* p = space.findPlanetPtr(id);
+        Planet* p = space.findPlanet(id);
         if (!p)
             return "ERR not found";
 
@@ -266,14 +324,15 @@ std::string UdpCommandServer::handleCommand(const std::string& line, Space& spac
         if (!(iss >> id))
             return "ERR invalid args";
 
-        Planet* p = space.findPlanetPtr(id);
+        Planet* p = space.findPlanet(id);
         if (!p)
             return "ERR not found";
 
+        const auto motion = *space.getPlanetMotion(id);
         std::ostringstream out;
         out << p->getId() << " "
-            << p->getx() << " " << p->gety() << " "
-            << p->getxv() << " " << p->getyv() << " "
+            << motion.x << " " << motion.y << " "
+            << motion.vx << " " << motion.vy << " "
             << p->getMass() << " " << p->getRadius() << " "
             << bodyTypeToString(p->getType()) << " "
             << p->getTemp();
@@ -303,6 +362,18 @@ std::string UdpCommandServer::handleCommand(const std::string& line, Space& spac
             << space.get_iteration();
         return out.str();
     }
+    else if (cmd == "TOTALS")
+    {
+        // mass, centre of mass x y, momentum x y, spin, kinetic, potential
+        const SystemAggregates& totals = space.getAggregates();
+        std::ostringstream out;
+        out << totals.mass << " "
+            << totals.centerX() << " " << totals.centerY() << " "
+            << totals.momentum_x << " " << totals.momentum_y << " "
+            << totals.spin() << " "
+            << totals.kinetic << " " << totals.potential;
+        return out.str();
+    }
     else if (cmd == "SET")
     {
         std::string key;
@@ -319,6 +390,24 @@ std::string UdpCommandServer::handleCommand(const std::string& line, Space& spac
         if (key == "render_life") { int v; if (!(iss >> v)) return "ERR missing value"; c.render_life_always = (v != 0); return "OK"; }
         if (key == "timestep") { float v; if (!(iss >> v)) return "ERR missing value"; c.timestep_slider_value = v; return "OK"; }
         if (key == "paused") { int v; if (!(iss >> v)) return "ERR missing value"; c.paused = (v != 0); return "OK"; }
+        if (key == "gravity_solver") { std::string v; if (!(iss >> v)) return "ERR missing value"; if (!parseGravitySolver(v, c.gravity_solver)) return "ERR unknown solver"; return "OK"; }
+        if (key == "bh_theta") { double v; if (!(iss >> v)) return "ERR missing value"; if (v < 0.0) return "ERR invalid value"; c.barnes_hut_theta = v; return "OK"; }
+        if (key == "fmm_order") { int v; if (!(iss >> v)) return "ERR missing value"; if (v < 0 || v > FmmSolver::MAX_ORDER) return "ERR invalid value"; c.fmm_order = v; return "OK"; }
+        if (key == "fmm_theta") { double v; if (!(iss >> v)) return "ERR missing value"; if (v <= 0.0 || v >= 1.0) return "ERR invalid value"; c.fmm_theta = v; return "OK"; }
+        if (key == "gravity_precision") { std::string v; if (!(iss >> v)) return "ERR missing value"; if (!parseGravityPrecision(v, c.gravity_precision)) return "ERR unknown precision"; return "OK"; }
+        if (key == "symmetric_pairs") { int v; if (!(iss >> v)) return "ERR missing value"; c.symmetric_pairs = (v != 0); return "OK"; }
+        if (key == "integrator") { std::string v; if (!(iss >> v)) return "ERR missing value"; if (!parseIntegrator(v, c.integrator)) return "ERR unknown integrator"; return "OK"; }
+        if (key == "neighbour_skin") { double v; if (!(iss >> v)) return "ERR missing value"; if (v < 0.0) return "ERR invalid value"; c.neighbour_skin = v; return "OK"; }
+        if (key == "continuous_collisions") { int v; if (!(iss >> v)) return "ERR missing value"; c.continuous_collisions = (v != 0); return "OK"; }
+        if (key == "reorder_interval") { int v; if (!(iss >> v)) return "ERR missing value"; if (v < 0) return "ERR invalid value"; c.reorder_interval = v; return "OK"; }
+        if (key == "reorder_disorder") { double v; if (!(iss >> v)) return "ERR missing value"; if (v < 0.0 || v > 1.0) return "ERR invalid value"; c.reorder_disorder = v; return "OK"; }
+        if (key == "passive_mass") { double v; if (!(iss >> v)) return "ERR missing value"; if (v < 0.0) return "ERR invalid value"; c.passive_mass = v; return "OK"; }
+        if (key == "worker_threads") { int v; if (!(iss >> v)) return "ERR missing value"; if (v < 0 || v > TaskPool::maxThreads()) return "ERR invalid value"; c.worker_threads = v; return "OK"; }
+        if (key == "parallel_autotune") { int v; if (!(iss >> v)) return "ERR missing value"; c.parallel_autotune = (v != 0); return "OK"; }
+        if (key == "encounter_subcycling") { int v; if (!(iss >> v)) return "ERR missing value"; c.encounter_subcycling = (v != 0); return "OK"; }
+        if (key == "block_timesteps") { int v; if (!(iss >> v)) return "ERR missing value"; c.block_timesteps = (v != 0); return "OK"; }
+        if (key == "max_time_rung") { int v; if (!(iss >> v)) return "ERR missing value"; if (v < 0 || v > 12) return "ERR invalid value"; c.max_time_rung = v; return "OK"; }
+        if (key == "time_rung_eta") { double v; if (!(iss >> v)) return "ERR missing value"; if (v <= 0.0) return "ERR invalid value"; c.time_rung_eta = v; return "OK"; }
 
         return "ERR unknown setting";
     }
@@ -338,6 +427,24 @@ std::string UdpCommandServer::handleCommand(const std::string& line, Space& spac
         if (key == "render_life") return std::to_string(c.render_life_always ? 1 : 0);
         if (key == "timestep") { std::ostringstream out; out << c.timestep_slider_value; return out.str(); }
         if (key == "paused") return std::to_string(c.paused ? 1 : 0);
+        if (key == "gravity_solver") return gravitySolverToString(c.gravity_solver);
+        if (key == "bh_theta") { std::ostringstream out; out << c.barnes_hut_theta; return out.str(); }
+        if (key == "fmm_order") return std::to_string(c.fmm_order);
+        if (key == "fmm_theta") { std::ostringstream out; out << c.fmm_theta; return out.str(); }
+        if (key == "gravity_precision") return gravityPrecisionToString(c.gravity_precision);
+        if (key == "symmetric_pairs") return std::to_string(c.symmetric_pairs ? 1 : 0);
+        if (key == "integrator") return integratorToString(c.integrator);
+        if (key == "neighbour_skin") { std::ostringstream out; out << c.neighbour_skin; return out.str(); }
+        if (key == "continuous_collisions") return std::to_string(c.continuous_collisions ? 1 : 0);
+        if (key == "reorder_interval") return std::to_string(c.reorder_interval);
+        if (key == "reorder_disorder") { std::ostringstream out; out << c.reorder_disorder; return out.str(); }
+        if (key == "passive_mass") { std::ostringstream out; out << c.passive_mass; return out.str(); }
+        if (key == "worker_threads") return std::to_string(c.worker_threads);
+        if (key == "parallel_autotune") return std::to_string(c.parallel_autotune ? 1 : 0);
+        if (key == "encounter_subcycling") return std::to_string(c.encounter_subcycling ? 1 : 0);
+        if (key == "block_timesteps") return std::to_string(c.block_timesteps ? 1 : 0);
+        if (key == "max_time_rung") return std::to_string(c.max_time_rung);
+        if (key == "time_rung_eta") { std::ostringstream out; out << c.time_rung_eta; return out.str(); }
 
         return "ERR unknown setting";
     }
@@ -55,13 +55,13 @@ namespace PredictionConfig
 
 using PhysicsBody = PhysicsUtils::PhysicsBody;
 
-PredictionResult predict_trajectory(const std::vector<Planet>& planets_orig, const Planet& subject, int steps)
+void predict_trajectory(const std::vector<Planet>& planets_orig, const Planet& subject, PredictionResult& result, std::pmr::memory_resource* scratch, int steps)
 {
 	const double opt_strength = std::min(1.0, static_cast<double>(planets_orig.size()) / 30.0);
 	const double mass_threshold = opt_strength * 5.0;
 	const double ratio_threshold = opt_strength * 0.05;
 
-	std::vector<PhysicsBody> planets;
+	std::pmr::vector<PhysicsBody> planets(scratch);
 	planets.reserve(planets_orig.size() + 1);
 	for (const auto& p : planets_orig)
 		planets.push_back({ p.getPosition(), p.getVelocity(), p.getMass(), p.getRadius(), p.getType() });
@@ -69,13 +69,17 @@ PredictionResult predict_trajectory(const std::vector<Planet>& planets_orig, con
 
 	const size_t subject_index = planets.size() - 1;
 	const double subject_mass = subject.getMass();
-	PredictionResult result;
+	result.path.clear();
+	result.collisionMarkers.clear();
+	result.reason = PredictionEndReason::MaxSteps;
+	result.endPoint = {};
+	result.endVelocity = {};
 	result.path.reserve(steps);
 
 	const float dt = PredictionConfig::PREDICTION_STEP_SIZE;
 
-	std::vector<Acceleration2D> acc_1(planets.size());
-	std::vector<Acceleration2D> acc_2(planets.size());
+	std::pmr::vector<Acceleration2D> acc_1(planets.size(), scratch);
+	std::pmr::vector<Acceleration2D> acc_2(planets.size(), scratch);
 
 	for (int i = 0; i < steps; i++)
 	{
@@ -203,8 +207,6 @@ PredictionResult predict_trajectory(const std::vector<Planet>& planets_orig, con
 			result.path[idx].color = c;
 		}
 	}
-	
-	return result;
 }
 
 void updateGuiSize(tgui::TextArea::Ptr textbox, int = 0)
@@ -286,7 +288,8 @@ public:
 					static_cast<float>(-speed_multiplier * to_now.y)
 				});
 				
-				auto result = predict_trajectory(context.space.planets, R);
+				PredictionResult result;
+				predict_trajectory(context.space.planets, R, result, context.space.frameArena().resource());
 				if (!result.path.empty())
 				{
 					context.window.draw(&result.path[0], result.path.size(), sf::PrimitiveType::LineStrip);
@@ -372,23 +375,17 @@ public:
 				if (!sf::Mouse::isButtonPressed(sf::Mouse::Left) || context.is_mouse_on_widgets)
 					break;
 
-				for (const auto & planet : context.space.planets)
+				if (const Planet* planet = context.space.planetAt(context.mouse_pos_world))
 				{
-					const auto dist = std::hypot(planet.getx() - context.mouse_pos_world.x,
-														planet.gety() - context.mouse_pos_world.y);
-					if (dist < planet.getRadius())
-					{
-						target_planet_id = planet.getId();
-						state = InOrbitFunctionState::PARENT_FOUND;
-						break;
-					}
+					target_planet_id = planet->getId();
+					state = InOrbitFunctionState::PARENT_FOUND;
 				}
 
 				break;
 			}
 		case InOrbitFunctionState::PARENT_FOUND:
 			{
-				Planet* target = context.space.findPlanetPtr(target_planet_id);
+				Planet* target = context.space.findPlanet(target_planet_id);
 				if (!target)
 				{
 					reset();
@@ -467,8 +464,12 @@ public:
 					//To keep total momentum change = 0
 					const float normalizing_speed = context.mass_slider->getValue() * speed / (context.mass_slider->getValue() + target->getMass());
 
-					target->setVelocity({ target->getxv() - normalizing_speed * cosf(angle + PI / 2.0),
-											target->getyv() - normalizing_speed * sinf(angle + PI / 2.0) });
+					if (auto motion = context.space.getPlanetMotion(target->getId()))
+					{
+						motion->vx -= normalizing_speed * cos(angle + PI / 2.0);
+						motion->vy -= normalizing_speed * sin(angle + PI / 2.0);
+						context.space.setPlanetMotion(target->getId(), *motion);
+					}
 
 					Planet new_planet(context.mass_slider->getValue(),
 						target->getx() + rad * cos(angle),
@@ -502,16 +503,8 @@ public:
 		if (!sf::Mouse::isButtonPressed(sf::Mouse::Left) || context.is_mouse_on_widgets)
 			return;
 
-		for (auto& planet : context.space.planets)
-		{
-			const auto dist = std::hypot(planet.getx() - context.mouse_pos_world.x,
-				planet.gety() - context.mouse_pos_world.y);
-			if (dist < planet.getRadius())
-			{
-				planet.markForRemoval();
-				return;
-			}
-		}
+		if (const Planet* planet = context.space.planetAt(context.mouse_pos_world))
+			context.space.removePlanet(planet->getId());
 	}
 };
 
@@ -568,23 +561,17 @@ public:
 			if (!sf::Mouse::isButtonPressed(sf::Mouse::Left) || context.is_mouse_on_widgets)
 				return;
 
-			for (const auto& planet : context.space.planets)
+			if (const Planet* planet = context.space.planetAt(context.mouse_pos_world))
 			{
-				const auto dist = std::hypot(planet.getx() - context.mouse_pos_world.x,
-					planet.gety() - context.mouse_pos_world.y);
-				if (dist < planet.getRadius())
-				{
-					target_planet_id = planet.getId();
-					state = AddRingsFunctionState::PARENT_FOUND;
-					break;
-				}
+				target_planet_id = planet->getId();
+				state = AddRingsFunctionState::PARENT_FOUND;
 			}
 
 			break;
 		}
 		case AddRingsFunctionState::PARENT_FOUND:
 			{
-				Planet* parent = context.space.findPlanetPtr(target_planet_id);
+				Planet* parent = context.space.findPlanet(target_planet_id);
 				if (!parent)
 				{
 					reset();
@@ -618,7 +605,7 @@ public:
 			}
 		case AddRingsFunctionState::INNER_CREATED:
 			{
-				Planet* parent = context.space.findPlanetPtr(target_planet_id);
+				Planet* parent = context.space.findPlanet(target_planet_id);
 				if (!parent)
 				{
 					reset();
@@ -877,16 +864,10 @@ public:
                  }
             }
 
-			for (const auto& planet : context.space.planets)
-			{
-				const auto dist = std::hypot(planet.getx() - context.mouse_pos_world.x,
-					planet.gety() - context.mouse_pos_world.y);
-				if (dist >= planet.getRadius())
-					continue;
-				context.space.object_tracker.activate(planet.getId());
-				return;
-			}
-			context.space.object_tracker.deactivate();
+			if (const Planet* planet = context.space.planetAt(context.mouse_pos_world))
+				context.space.object_tracker.activate(planet->getId());
+			else
+				context.space.object_tracker.deactivate();
 		}
 	}
 };
@@ -911,16 +892,8 @@ public:
 	{
 		if (sf::Mouse::isButtonPressed(sf::Mouse::Left) && !context.is_mouse_on_widgets)
 		{
-			for (const auto& planet : context.space.planets)
-			{
-				const auto dist = std::hypot(planet.getx() - context.mouse_pos_world.x,
-					planet.gety() - context.mouse_pos_world.y);
-				if (dist >= planet.getRadius())
-					continue;
-
-				context.space.object_info.activate(planet.getId());
-				return;
-			}
+			if (const Planet* planet = context.space.planetAt(context.mouse_pos_world))
+				context.space.object_info.activate(planet->getId());
 		}
 	}
 };
@@ -952,8 +925,15 @@ public:
 
 		if (event.mouseButton.button == sf::Mouse::Left && !context.is_mouse_on_widgets)
 		{
-			for (const auto& planet : context.space.planets)
+			// Every planet under the cursor is toggled, in list order
+			std::vector<int> clicked;
+			context.space.planet_index.queryCircle(context.mouse_pos_world.x, context.mouse_pos_world.y, 0.0,
+				[&](const SpatialIndex::Entry& e) { clicked.push_back(e.item); });
+			std::sort(clicked.begin(), clicked.end());
+
+			for (const int index : clicked)
 			{
+				const Planet& planet = context.space.planets[index];
 				if (std::hypot(planet.getx() - context.mouse_pos_world.x,
 					planet.gety() - context.mouse_pos_world.y) < planet.getRadius())
 				{
@@ -988,10 +968,11 @@ public:
 
 				for (const auto id : object_ids)
 				{
-					if (Planet* planet = context.space.findPlanetPtr(id))
+					if (auto motion = context.space.getPlanetMotion(id))
 					{
-						planet->setVelocity({ planet->getxv() - adjust_speed * cosf(angle + PI / 2.0), 
-							planet->getyv() - adjust_speed * sinf(angle + PI / 2.0) });
+						motion->vx -= adjust_speed * cos(angle + PI / 2.0);
+						motion->vy -= adjust_speed * sin(angle + PI / 2.0);
+						context.space.setPlanetMotion(id, *motion);
 					}
 				}
 
@@ -1008,7 +989,7 @@ public:
 		std::erase_if(object_ids,
 			[&context](auto id)
 			{
-				return !context.space.findPlanetPtr(id);
+				return !context.space.findPlanet(id);
 			});
 
 		if (object_ids.empty())
@@ -1016,7 +997,7 @@ public:
 
 		for (const auto id : object_ids)
 		{
-			Planet* planet = context.space.findPlanetPtr(id);
+			Planet* planet = context.space.findPlanet(id);
 			
 			sf::CircleShape indicator(planet->getRadius() + 10);
 			indicator.setPosition(planet->getx(), planet->gety());
@@ -1074,15 +1055,8 @@ public:
 
 		if (event.mouseButton.button == sf::Mouse::Left && !context.is_mouse_on_widgets)
 		{
-			for (const auto planet : context.space.planets)
-			{
-				if (std::hypot(planet.getx() - context.mouse_pos_world.x,
-					planet.gety() - context.mouse_pos_world.y) < planet.getRadius())
-				{
-					context.space.explodePlanet(planet);
-					return;
-				}
-			}
+			if (const Planet* planet = context.space.planetAt(context.mouse_pos_world))
+				context.space.explodePlanet(planet->getId());
 		}
 	}
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory_resource>
 #include <string>
 #include <vector>
 
@@ -91,7 +92,9 @@ struct PredictionResult {
 	std::vector<CollisionMarker> collisionMarkers;
 };
 
-PredictionResult predict_trajectory(const std::vector<class CelestialBody>& planets_orig, const class CelestialBody& subject, int steps = 200);
+// Overwrites `result`, reusing its storage. The working copies of the bodies are taken from `scratch`.
+void predict_trajectory(const std::vector<class CelestialBody>& planets_orig, const class CelestialBody& subject, PredictionResult& result,
+	std::pmr::memory_resource* scratch = std::pmr::get_default_resource(), int steps = 200);
 
 void executeFunction(FunctionContext& context);
 void giveFunctionEvent(FunctionContext& context, sf::Event event);
\ No newline at end of file